@@ -16,5 +16,5 @@ end=`date +%s%N`
 let "build_time = ($end - $start) / 1000000"
 echo Build time: $build_time ms.
 
-# Application execution
-./pcr3bp_code
+# Application execution (all proof stages executed concurrently, see README.md)
+./pcr3bp_code --gtest_filter=Pcr3bp_full_proof.*
@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Sharded execution of the covering relation checks (see README.md)
+#
+# Usage: bash run_sharded.sh [shard count] [result directory]
+#
+# Every shard is a separate process running the part of the checks assigned to it. The shards are launched locally here,
+# but the same PCR3BP_SHARD_* variables may be used to launch the shards on different machines sharing the result
+# directory.
+
+shard_count=${1:-4}
+result_dir=${2:-shard_results}
+
+mkdir -p "$result_dir" || exit 1
+rm -f "$result_dir"/shard_*_of_$shard_count.tsv
+
+# the shards run in the build directory, so a relative result directory is resolved first
+result_dir=$(cd "$result_dir" && pwd) || exit 1
+
+cd build || exit 1
+
+for (( i=0; i<$shard_count; i++ ))
+do
+    PCR3BP_SHARD_INDEX=$i PCR3BP_SHARD_COUNT=$shard_count PCR3BP_SHARD_RESULT_DIR="$result_dir" \
+        ./pcr3bp_code --gtest_filter=Pcr3bp_sharded_proof.shard > "$result_dir/shard_$i.log" 2>&1 &
+done
+
+wait
+
+PCR3BP_SHARD_COUNT=$shard_count PCR3BP_SHARD_RESULT_DIR="$result_dir" ./pcr3bp_code --gtest_filter=Pcr3bp_sharded_proof.merge
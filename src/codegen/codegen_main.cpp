@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "expression_graph.hpp"
+#include "evaluator_emitter.hpp"
+
+#include <pcr3bp_basic/standard_system.hpp>
+#include <pcr3bp_basic/regularized_system.hpp>
+#include <pcr3bp_basic/levi_civita_coordinate_change.hpp>
+#include <pcr3bp_basic/levi_civita_inverse_coordinate_change.hpp>
+#include <tools/auxiliary_functions.hpp>
+#include <tools/psi0_specialized.hpp>
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Generator of the C++ evaluators of the PCR3BP maps
+//! @details Traces the map definitions (the same builders that create the CAPD maps, instantiated with TracingMap) and
+//!          writes the evaluators to the header given as the only argument. The numerical values of the parameters are
+//!          not part of the evaluators, they are copied from the CAPD maps at runtime (see GeneratedMap).
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    using namespace Pcr3bpProof;
+    using Codegen::TracingMap;
+
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <output header>\n";
+        return 1;
+    }
+
+    const Pcr3bp::SetupParameters<TracingMap> setup {};
+
+    using RegularizedSystem = Pcr3bp::RegularizedSystem<TracingMap>;
+    using StandardSystem = Pcr3bp::StandardSystem<TracingMap>;
+    using InversePieces = LeviCivitaInverseCoordinateChangePieces<TracingMap>;
+
+    const std::vector<std::pair<std::string, std::function<TracingMap()>>> definitions
+    {
+        { "StandardHamiltonian", [&]() { return StandardSystem::createHamiltonian(setup); } },
+        { "StandardVectorField", [&]() { return StandardSystem::createPositiveVectorField(setup); } },
+        { "RegularizedHamiltonian", [&]() { return RegularizedSystem::createHamiltonian(2, setup); } },
+        { "RegularizedHamiltonian4", [&]() { return RegularizedSystem::createHamiltonian4(2, setup, 0.0); } },
+        { "RegularizedHamiltonianGradient4", [&]() { return RegularizedSystem::createHamiltonianGradient4(2, setup, 0.0); } },
+        { "RegularizedVectorField", [&]() { return RegularizedSystem::createPositiveVectorField(2, setup, false); } },
+        { "RegularizedVectorField4", [&]() { return RegularizedSystem::createPositiveVectorField4(2, setup, 0.0); } },
+        { "CollisionCondition", [&]() { return RegularizedSystem::createCollisionCondition(2, setup); } },
+        { "LeviCivitaCoordinateChange", [&]() { return LeviCivitaCoordinateChange<TracingMap>::create(2, setup, true, true, false); } },
+        { "LeviCivitaCoordinateChangeInverse", [&]() { return LeviCivitaCoordinateChange<TracingMap>::createInverse(2, setup, true, true); } },
+        { "LeviCivitaInverseF1", [&]() { return InversePieces::create_f1(0.0, true); } },
+        { "LeviCivitaInverseF2", [&]() { return InversePieces::create_f2(0.0, true); } },
+        { "LeviCivitaInverseF3", [&]() { return InversePieces::create_f3(0.0, true); } },
+        { "LeviCivitaInverseF4", [&]() { return InversePieces::create_f4(0.0, true); } },
+        { "LeviCivitaInverseG", [&]() { return InversePieces::create_g(true); } },
+        { "Eta", [&]() { return AuxiliaryFunctions<TracingMap>::eta(0.0); } },
+        { "R_Inverse", [&]() { return AuxiliaryFunctions<TracingMap>::R_Inverse(0.0, 1.0); } },
+        { "J", [&]() { return AuxiliaryFunctions<TracingMap>::J(); } },
+        { "Psi0Inverse", [&]() { return AuxiliaryFunctions<TracingMap>::create_psi0_inverse({ 1.0, 1.0 }); } },
+        { "Psi0Specialized", [&]() { return Psi0_specialized<TracingMap>::create(0.0, setup); } },
+    };
+
+    std::ofstream out(argv[1]);
+    if (!out)
+    {
+        std::cerr << "Unable to write " << argv[1] << '\n';
+        return 1;
+    }
+
+    out << "// Generated by pcr3bp_codegen from the map definitions, do not edit.\n\n";
+    out << "#pragma once\n\n";
+    out << "#include \"codegen/series_ops.hpp\"\n\n";
+    out << "#include <cmath>\n";
+    out << "#include <vector>\n\n";
+    out << "namespace Pcr3bpProof\n{\nnamespace Generated\n{\n\n";
+
+    for (const auto& definition : definitions)
+    {
+        const TracingMap map = definition.second();
+        const Codegen::EvaluatorEmitter emitter { map, definition.first + "Evaluator" };
+
+        emitter.emit(out);
+
+        std::cout << definition.first << ": " << map.get_graph().size() << " traced, "
+                  << emitter.get_operation_count() << " emitted operations\n";
+    }
+
+    out << "}\n}\n";
+
+    return out ? 0 : 1;
+}
@@ -0,0 +1,397 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "expression_graph.hpp"
+#include "graph_optimizer.hpp"
+
+#include <cstdio>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Pcr3bpProof
+{
+namespace Codegen
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Emitter of straight-line C++ evaluators of traced maps
+//! @details For a traced map the emitter writes a class template (parametrized with the scalar type) with static functions
+//!
+//!           value(in, param, out)                    - value of the map,
+//!           derivative(in, param, out, der)          - value and derivative (row-major) in forward mode,
+//!           taylor(param, coeffs, order)             - Taylor coefficients of the solution of x' = f(x) (vector fields only),
+//!
+//!          The traced graph is optimized first (see GraphOptimizer), so only operations reachable from the outputs are
+//!          emitted and identical subexpressions are evaluated once. Operations that do not depend on the inputs are
+//!          evaluated once and treated as scalars in the derivative and in the Taylor coefficient recurrences. Constants
+//!          are written as hexadecimal floating point literals, so they are exactly the doubles of the definitions.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class EvaluatorEmitter
+{
+public:
+    EvaluatorEmitter(const TracingMap& map, std::string name)
+        : m_optimizer(map.get_graph(), map.get_outputs())
+        , m_graph(m_optimizer.get_graph())
+        , m_outputs(m_optimizer.get_outputs())
+        , m_dimension(map.dimension())
+        , m_image_dimension(map.imageDimension())
+        , m_parameter_count(map.get_parameter_values().size())
+        , m_name(std::move(name))
+        , m_reachable(m_graph.size(), false)
+        , m_dependent(m_graph.size(), false)
+    {
+        for (size_t id : m_outputs)
+        {
+            m_reachable.at(id) = true;
+        }
+
+        for (size_t id = m_graph.size(); id-- > 0; )
+        {
+            const Operation& operation = m_graph.at(id);
+            if (m_reachable.at(id) && (operation.is_unary() || operation.is_binary()))
+            {
+                m_reachable.at(operation.lhs) = true;
+                if (operation.is_binary())
+                {
+                    m_reachable.at(operation.rhs) = true;
+                }
+            }
+        }
+
+        for (size_t id = 0; id < m_graph.size(); ++id)
+        {
+            const Operation& operation = m_graph.at(id);
+            m_dependent.at(id) =
+                operation.kind == Operation::Kind::Input ||
+                ((operation.is_unary() || operation.is_binary()) && m_dependent.at(operation.lhs)) ||
+                (operation.is_binary() && m_dependent.at(operation.rhs));
+        }
+    }
+
+    void emit(std::ostream& out) const
+    {
+        out << "template<typename ScalarType>\n";
+        out << "struct " << m_name << "\n{\n";
+        out << "    static constexpr unsigned dimension = " << m_dimension << ";\n";
+        out << "    static constexpr unsigned image_dimension = " << m_image_dimension << ";\n";
+        out << "    static constexpr unsigned parameter_count = " << m_parameter_count << ";\n\n";
+
+        emit_value(out);
+        emit_derivative(out);
+
+        if (m_dimension == m_image_dimension)
+        {
+            emit_taylor(out);
+        }
+
+        out << "};\n\n";
+    }
+
+    size_t get_operation_count() const
+    {
+        size_t ret = 0;
+        for (bool reachable : m_reachable)
+        {
+            ret += reachable ? 1 : 0;
+        }
+        return ret;
+    }
+
+private:
+    static std::string hex(double value)
+    {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%a", value);
+        return buffer;
+    }
+
+    static std::string literal(double value)
+    {
+        return "ScalarType(" + hex(value) + ")";
+    }
+
+    static std::string n(size_t id)
+    {
+        return "n" + std::to_string(id);
+    }
+
+    static std::string d(size_t id)
+    {
+        return "d" + std::to_string(id);
+    }
+
+    static std::string s(size_t id)
+    {
+        return "s" + std::to_string(id);
+    }
+
+    std::string value_expression(size_t id) const
+    {
+        const Operation& op = m_graph.at(id);
+
+        switch (op.kind)
+        {
+            case Operation::Kind::Constant: return literal(op.value);
+            case Operation::Kind::Input: return "in[" + std::to_string(op.index) + "]";
+            case Operation::Kind::Parameter: return "param[" + std::to_string(op.index) + "]";
+            case Operation::Kind::Add: return n(op.lhs) + " + " + n(op.rhs);
+            case Operation::Kind::Sub: return n(op.lhs) + " - " + n(op.rhs);
+            case Operation::Kind::Mul: return n(op.lhs) + " * " + n(op.rhs);
+            case Operation::Kind::Div: return n(op.lhs) + " / " + n(op.rhs);
+            case Operation::Kind::Neg: return "-" + n(op.lhs);
+            case Operation::Kind::Sqr: return "Codegen::square(" + n(op.lhs) + ")";
+            case Operation::Kind::Sqrt: return "sqrt(" + n(op.lhs) + ")";
+            case Operation::Kind::Pow: return "Codegen::power(" + n(op.lhs) + ", " + hex(op.value) + ")";
+        }
+
+        throw std::logic_error("Unknown operation!");
+    }
+
+    void emit_values(std::ostream& out, bool only_independent) const
+    {
+        for (size_t id = 0; id < m_graph.size(); ++id)
+        {
+            if (m_reachable.at(id) && !(only_independent && m_dependent.at(id)))
+            {
+                out << "        const ScalarType " << n(id) << " = " << value_expression(id) << ";\n";
+            }
+        }
+    }
+
+    void emit_value(std::ostream& out) const
+    {
+        out << "    static void value(const ScalarType* in, const ScalarType* param, ScalarType* out)\n    {\n";
+        out << "        using std::sqrt;\n";
+        out << "        (void)in; (void)param;\n\n";
+
+        emit_values(out, false);
+
+        out << "\n";
+        for (size_t r = 0; r < m_outputs.size(); ++r)
+        {
+            out << "        out[" << r << "] = " << n(m_outputs.at(r)) << ";\n";
+        }
+        out << "    }\n\n";
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Derivative term of the argument (empty if the argument does not depend on the inputs)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    std::string dterm(size_t id, const std::string& factor = "") const
+    {
+        if (!m_dependent.at(id))
+        {
+            return "";
+        }
+
+        return factor.empty() ? d(id) + "[j]" : factor + " * " + d(id) + "[j]";
+    }
+
+    static std::string join(const std::string& lhs, const std::string& op, const std::string& rhs)
+    {
+        if (lhs.empty())
+        {
+            return (op == " - ") ? "-(" + rhs + ")" : rhs;
+        }
+
+        return rhs.empty() ? lhs : lhs + op + rhs;
+    }
+
+    std::string derivative_expression(size_t id) const
+    {
+        const Operation& op = m_graph.at(id);
+
+        switch (op.kind)
+        {
+            case Operation::Kind::Add: return join(dterm(op.lhs), " + ", dterm(op.rhs));
+            case Operation::Kind::Sub: return join(dterm(op.lhs), " - ", dterm(op.rhs));
+            case Operation::Kind::Mul: return join(dterm(op.lhs, n(op.rhs)), " + ", dterm(op.rhs, n(op.lhs)));
+            case Operation::Kind::Div: return "(" + join(dterm(op.lhs), " - ", dterm(op.rhs, n(id))) + ") / " + n(op.rhs);
+            case Operation::Kind::Neg: return "-" + dterm(op.lhs);
+            case Operation::Kind::Sqr: return dterm(op.lhs, "ScalarType(2.0) * " + n(op.lhs));
+            case Operation::Kind::Sqrt: return dterm(op.lhs) + " / (ScalarType(2.0) * " + n(id) + ")";
+            case Operation::Kind::Pow:
+                return dterm(op.lhs, literal(op.value) + " * " + n(id) + " / " + n(op.lhs));
+            default: break;
+        }
+
+        throw std::logic_error("Unexpected dependent operation!");
+    }
+
+    void emit_derivative(std::ostream& out) const
+    {
+        out << "    static void derivative(const ScalarType* in, const ScalarType* param, ScalarType* out, ScalarType* der)\n";
+        out << "    {\n";
+        out << "        using std::sqrt;\n";
+        out << "        (void)in; (void)param;\n\n";
+
+        for (size_t id = 0; id < m_graph.size(); ++id)
+        {
+            if (!m_reachable.at(id))
+            {
+                continue;
+            }
+
+            out << "        const ScalarType " << n(id) << " = " << value_expression(id) << ";\n";
+
+            if (!m_dependent.at(id))
+            {
+                continue;
+            }
+
+            const Operation& op = m_graph.at(id);
+            out << "        ScalarType " << d(id) << "[" << m_dimension << "];\n";
+
+            if (op.kind == Operation::Kind::Input)
+            {
+                out << "        for (unsigned j = 0; j < " << m_dimension << "; ++j) " << d(id) << "[j] = ScalarType(j == "
+                    << op.index << " ? 1.0 : 0.0);\n";
+            }
+            else
+            {
+                out << "        for (unsigned j = 0; j < " << m_dimension << "; ++j) " << d(id) << "[j] = "
+                    << derivative_expression(id) << ";\n";
+            }
+        }
+
+        out << "\n";
+        for (size_t r = 0; r < m_outputs.size(); ++r)
+        {
+            const size_t id = m_outputs.at(r);
+
+            out << "        out[" << r << "] = " << n(id) << ";\n";
+            out << "        for (unsigned j = 0; j < " << m_dimension << "; ++j) der[" << r * m_dimension << " + j] = "
+                << (m_dependent.at(id) ? d(id) + "[j]" : std::string("ScalarType(0.0)")) << ";\n";
+        }
+        out << "    }\n\n";
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief k-th Taylor coefficient of a dependent operation
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    std::string series_expression(size_t id) const
+    {
+        const Operation& op = m_graph.at(id);
+
+        const bool lhs = m_dependent.at(op.lhs);
+        const bool rhs = op.is_binary() && m_dependent.at(op.rhs);
+
+        const std::string a = s(op.lhs);
+        const std::string b = op.is_binary() ? s(op.rhs) : "";
+        const std::string ca = n(op.lhs);
+        const std::string cb = op.is_binary() ? n(op.rhs) : "";
+
+        switch (op.kind)
+        {
+            case Operation::Kind::Add:
+                if (lhs && rhs) return a + "[k] + " + b + "[k]";
+                if (lhs) return "(k == 0) ? " + a + "[0] + " + cb + " : " + a + "[k]";
+                return "(k == 0) ? " + ca + " + " + b + "[0] : " + b + "[k]";
+            case Operation::Kind::Sub:
+                if (lhs && rhs) return a + "[k] - " + b + "[k]";
+                if (lhs) return "(k == 0) ? " + a + "[0] - " + cb + " : " + a + "[k]";
+                return "(k == 0) ? " + ca + " - " + b + "[0] : -" + b + "[k]";
+            case Operation::Kind::Mul:
+                if (lhs && rhs) return "Series::mul(" + a + ", " + b + ", k)";
+                if (lhs) return a + "[k] * " + cb;
+                return ca + " * " + b + "[k]";
+            case Operation::Kind::Div:
+                if (lhs && rhs) return "Series::div(" + a + ", " + b + ", " + s(id) + ", k)";
+                if (lhs) return a + "[k] / " + cb;
+                return "Series::scalar_div(" + ca + ", " + b + ", " + s(id) + ", k)";
+            case Operation::Kind::Neg: return "-" + a + "[k]";
+            case Operation::Kind::Sqr: return "Series::sqr(" + a + ", k)";
+            case Operation::Kind::Sqrt: return "Series::sqrt(" + a + ", " + s(id) + ", k)";
+            case Operation::Kind::Pow: return "Series::pow(" + a + ", " + hex(op.value) + ", " + s(id) + ", k)";
+            default: break;
+        }
+
+        throw std::logic_error("Unexpected dependent operation!");
+    }
+
+    void emit_taylor(std::ostream& out) const
+    {
+        std::vector<size_t> series_ids {};
+        for (size_t id = 0; id < m_graph.size(); ++id)
+        {
+            if (m_reachable.at(id) && m_dependent.at(id))
+            {
+                series_ids.push_back(id);
+            }
+        }
+
+        std::ostringstream body {};
+        for (size_t id : series_ids)
+        {
+            const Operation& op = m_graph.at(id);
+
+            body << "            " << s(id) << "[k] = ";
+            if (op.kind == Operation::Kind::Input)
+            {
+                body << "coeffs[k * " << m_dimension << " + " << op.index << "];\n";
+            }
+            else
+            {
+                body << series_expression(id) << ";\n";
+            }
+        }
+
+        out << "    //! coeffs[k * dimension + i] is the k-th Taylor coefficient of x_i, coefficients of order 0 are given\n";
+        out << "    static void taylor(const ScalarType* param, ScalarType* coeffs, size_t order)\n";
+        out << "    {\n";
+        out << "        using std::sqrt;\n";
+        if (body.str().find("Series::") != std::string::npos)
+        {
+            out << "        using Series = Codegen::SeriesOps<ScalarType>;\n";
+        }
+        out << "        (void)param;\n\n";
+
+        emit_values(out, true);
+
+        out << "\n        std::vector<ScalarType> series((order + 1) * " << series_ids.size() << ", ScalarType(0.0));\n";
+        for (size_t i = 0; i < series_ids.size(); ++i)
+        {
+            out << "        ScalarType* const " << s(series_ids.at(i)) << " = series.data() + " << i << " * (order + 1);\n";
+        }
+
+        out << "\n        for (size_t k = 0; k < order; ++k)\n        {\n";
+        out << body.str();
+
+        out << "\n            const ScalarType factor = ScalarType(1.0) / ScalarType(double(k + 1));\n";
+        for (size_t r = 0; r < m_outputs.size(); ++r)
+        {
+            const size_t id = m_outputs.at(r);
+
+            out << "            coeffs[(k + 1) * " << m_dimension << " + " << r << "] = ";
+            if (m_dependent.at(id))
+            {
+                out << s(id) << "[k] * factor;\n";
+            }
+            else
+            {
+                out << "(k == 0) ? " << n(id) << " * factor : ScalarType(0.0);\n";
+            }
+        }
+
+        out << "        }\n    }\n";
+    }
+
+    const GraphOptimizer m_optimizer;
+    const ExpressionGraph& m_graph;
+    const std::vector<size_t> m_outputs;
+    const unsigned m_dimension;
+    const unsigned m_image_dimension;
+    const size_t m_parameter_count;
+    const std::string m_name;
+
+    std::vector<bool> m_reachable;
+    std::vector<bool> m_dependent;
+};
+
+}
+}
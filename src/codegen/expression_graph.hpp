@@ -0,0 +1,319 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <tools/types.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace Pcr3bpProof
+{
+namespace Codegen
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Single operation of an expression graph
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct Operation
+{
+    enum class Kind
+    {
+        Constant,
+        Input,
+        Parameter,
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Neg,
+        Sqr,
+        Sqrt,
+        Pow
+    };
+
+    Kind kind { Kind::Constant };
+    size_t lhs { 0 };
+    size_t rhs { 0 };
+
+    //! value of a constant or exponent of a power
+    double value { 0.0 };
+
+    //! index of an input or parameter
+    size_t index { 0 };
+
+    bool is_unary() const noexcept
+    {
+        return kind == Kind::Neg || kind == Kind::Sqr || kind == Kind::Sqrt || kind == Kind::Pow;
+    }
+
+    bool is_binary() const noexcept
+    {
+        return kind == Kind::Add || kind == Kind::Sub || kind == Kind::Mul || kind == Kind::Div;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Expression graph recorded from a map definition
+//! @details Operations are stored in topological order, i.e. arguments of an operation precede it.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ExpressionGraph
+{
+public:
+    size_t add(const Operation& operation)
+    {
+        m_operations.push_back(operation);
+        return m_operations.size() - 1;
+    }
+
+    const Operation& at(size_t id) const
+    {
+        return m_operations.at(id);
+    }
+
+    size_t size() const noexcept
+    {
+        return m_operations.size();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Graph used by nodes created from numbers during tracing
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static ExpressionGraph*& current() noexcept
+    {
+        static thread_local ExpressionGraph* s_current { nullptr };
+        return s_current;
+    }
+
+private:
+    std::vector<Operation> m_operations {};
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Node type substituted for CapdUtils::Node when a map definition is traced
+//! @details Supports the subset of the CAPD node operations used by the definitions of the PCR3BP maps. Every operation
+//!          appends an operation to the graph, so after tracing the graph contains the whole map.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TracedNode
+{
+public:
+    TracedNode() = default;
+
+    TracedNode(double value) : m_graph(ExpressionGraph::current())
+    {
+        if (!m_graph)
+        {
+            throw std::logic_error("TracedNode created outside of tracing!");
+        }
+
+        Operation operation {};
+        operation.kind = Operation::Kind::Constant;
+        operation.value = value;
+        m_id = m_graph->add(operation);
+    }
+
+    TracedNode(ExpressionGraph& graph, size_t id) : m_graph(&graph), m_id(id)
+    {}
+
+    ExpressionGraph& get_graph() const
+    {
+        if (!m_graph)
+        {
+            throw std::logic_error("TracedNode used before assignment!");
+        }
+
+        return *m_graph;
+    }
+
+    size_t get_id() const noexcept
+    {
+        return m_id;
+    }
+
+    bool is_assigned() const noexcept
+    {
+        return m_graph != nullptr;
+    }
+
+    static TracedNode unary(Operation::Kind kind, const TracedNode& arg, double value = 0.0)
+    {
+        Operation operation {};
+        operation.kind = kind;
+        operation.lhs = arg.get_id();
+        operation.value = value;
+        return TracedNode(arg.get_graph(), arg.get_graph().add(operation));
+    }
+
+    static TracedNode binary(Operation::Kind kind, const TracedNode& lhs, const TracedNode& rhs)
+    {
+        Operation operation {};
+        operation.kind = kind;
+        operation.lhs = lhs.get_id();
+        operation.rhs = rhs.get_id();
+        return TracedNode(lhs.get_graph(), lhs.get_graph().add(operation));
+    }
+
+    TracedNode& operator+= (const TracedNode& other)
+    {
+        return *this = binary(Operation::Kind::Add, *this, other);
+    }
+
+    TracedNode& operator-= (const TracedNode& other)
+    {
+        return *this = binary(Operation::Kind::Sub, *this, other);
+    }
+
+    TracedNode& operator*= (const TracedNode& other)
+    {
+        return *this = binary(Operation::Kind::Mul, *this, other);
+    }
+
+    TracedNode& operator/= (const TracedNode& other)
+    {
+        return *this = binary(Operation::Kind::Div, *this, other);
+    }
+
+    friend TracedNode operator+ (const TracedNode& lhs, const TracedNode& rhs) { return binary(Operation::Kind::Add, lhs, rhs); }
+    friend TracedNode operator- (const TracedNode& lhs, const TracedNode& rhs) { return binary(Operation::Kind::Sub, lhs, rhs); }
+    friend TracedNode operator* (const TracedNode& lhs, const TracedNode& rhs) { return binary(Operation::Kind::Mul, lhs, rhs); }
+    friend TracedNode operator/ (const TracedNode& lhs, const TracedNode& rhs) { return binary(Operation::Kind::Div, lhs, rhs); }
+
+    friend TracedNode operator+ (double lhs, const TracedNode& rhs) { return TracedNode(lhs) + rhs; }
+    friend TracedNode operator- (double lhs, const TracedNode& rhs) { return TracedNode(lhs) - rhs; }
+    friend TracedNode operator* (double lhs, const TracedNode& rhs) { return TracedNode(lhs) * rhs; }
+    friend TracedNode operator/ (double lhs, const TracedNode& rhs) { return TracedNode(lhs) / rhs; }
+
+    friend TracedNode operator+ (const TracedNode& lhs, double rhs) { return lhs + TracedNode(rhs); }
+    friend TracedNode operator- (const TracedNode& lhs, double rhs) { return lhs - TracedNode(rhs); }
+    friend TracedNode operator* (const TracedNode& lhs, double rhs) { return lhs * TracedNode(rhs); }
+    friend TracedNode operator/ (const TracedNode& lhs, double rhs) { return lhs / TracedNode(rhs); }
+
+    friend TracedNode operator- (const TracedNode& arg) { return unary(Operation::Kind::Neg, arg); }
+
+    // found by argument dependent lookup only, so that they do not interfere with the scalar functions
+    friend TracedNode sqr(const TracedNode& arg) { return unary(Operation::Kind::Sqr, arg); }
+    friend TracedNode sqrt(const TracedNode& arg) { return unary(Operation::Kind::Sqrt, arg); }
+    friend TracedNode operator^ (const TracedNode& arg, double exponent) { return unary(Operation::Kind::Pow, arg, exponent); }
+
+private:
+    ExpressionGraph* m_graph { nullptr };
+    size_t m_id { 0 };
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Map type substituted for CAPD maps when the map definitions are traced
+//! @details Provides the part of the CAPD map interface used by the map builders (construction from a node function and
+//!          setParameter). The node function is called once in the constructor with traced inputs and parameters.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TracingMap
+{
+public:
+    using ScalarType = double;
+    using VectorType = std::vector<double>;
+    using MatrixType = std::vector<std::vector<double>>;
+
+    template<typename FunctionT>
+    TracingMap(FunctionT function, int dimension, int image_dimension, int parameter_count)
+        : m_graph(std::make_shared<ExpressionGraph>())
+        , m_dimension(dimension)
+        , m_image_dimension(image_dimension)
+        , m_parameter_values(parameter_count, 0.0)
+    {
+        ExpressionGraph*& current = ExpressionGraph::current();
+        ExpressionGraph* const previous = current;
+        current = m_graph.get();
+
+        try
+        {
+            std::vector<TracedNode> in(dimension);
+            std::vector<TracedNode> out(image_dimension);
+            std::vector<TracedNode> param(parameter_count);
+
+            for (int i = 0; i < dimension; ++i)
+            {
+                Operation operation {};
+                operation.kind = Operation::Kind::Input;
+                operation.index = i;
+                in[i] = TracedNode(*m_graph, m_graph->add(operation));
+            }
+
+            for (int i = 0; i < parameter_count; ++i)
+            {
+                Operation operation {};
+                operation.kind = Operation::Kind::Parameter;
+                operation.index = i;
+                param[i] = TracedNode(*m_graph, m_graph->add(operation));
+            }
+
+            function(TracedNode(0.0), in.data(), dimension, out.data(), image_dimension, param.data(), parameter_count);
+
+            for (const TracedNode& node : out)
+            {
+                m_outputs.push_back(node.get_id());
+
+                if (!node.is_assigned())
+                {
+                    throw std::logic_error("Output of the traced map not assigned!");
+                }
+            }
+        }
+        catch (...)
+        {
+            current = previous;
+            throw;
+        }
+
+        current = previous;
+    }
+
+    void setParameter(int i, double value)
+    {
+        m_parameter_values.at(i) = value;
+    }
+
+    const ExpressionGraph& get_graph() const noexcept
+    {
+        return *m_graph;
+    }
+
+    const std::vector<size_t>& get_outputs() const noexcept
+    {
+        return m_outputs;
+    }
+
+    const std::vector<double>& get_parameter_values() const noexcept
+    {
+        return m_parameter_values;
+    }
+
+    unsigned dimension() const noexcept
+    {
+        return m_dimension;
+    }
+
+    unsigned imageDimension() const noexcept
+    {
+        return m_image_dimension;
+    }
+
+private:
+    std::shared_ptr<ExpressionGraph> m_graph;
+    unsigned m_dimension;
+    unsigned m_image_dimension;
+    std::vector<double> m_parameter_values;
+    std::vector<size_t> m_outputs {};
+};
+
+}
+
+template<>
+struct NodeTypeOf<Codegen::TracingMap>
+{
+    using type = Codegen::TracedNode;
+};
+
+}
@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <capd_utils/map_base.hpp>
+
+#include "tools/test_tools.hpp"
+
+#include <vector>
+
+namespace Pcr3bpProof
+{
+namespace Codegen
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Map evaluated by a generated evaluator
+//! @details Interchangeable with the CAPD map built from the same definition: the parameters are copied from that map (or
+//!          set with setParameter) and the map implements the MapBase interface. For vector fields the Taylor coefficients
+//!          of solutions are provided with the same signature as in CAPD maps.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT, template<typename> class EvaluatorT>
+class GeneratedMap : public CapdUtils::MapBase<MapT>
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+    using VectorType = typename MapT::VectorType;
+    using MatrixType = typename MapT::MatrixType;
+    using size_type = typename MatrixType::size_type;
+
+    using Evaluator = EvaluatorT<ScalarType>;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //!
+    //! @param reference CAPD map built from the same definition, the source of the parameter values
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    explicit GeneratedMap(const MapT& reference) : m_parameters(Evaluator::parameter_count, ScalarType(0.0))
+    {
+        assert_with_exception(reference.dimension() == Evaluator::dimension);
+        assert_with_exception(reference.imageDimension() == Evaluator::image_dimension);
+
+        for (unsigned i = 0; i < Evaluator::parameter_count; ++i)
+        {
+            m_parameters.at(i) = reference.getParameter(i);
+        }
+    }
+
+    void setParameter(unsigned i, const ScalarType& value)
+    {
+        m_parameters.at(i) = value;
+    }
+
+    VectorType operator() (const VectorType& vec) override
+    {
+        this->assert_vector_size(vec, dimension(), "GeneratedMap vec vector size mismatch (1)!");
+
+        ScalarType in[Evaluator::dimension];
+        ScalarType out[Evaluator::image_dimension];
+
+        load(vec, in);
+        Evaluator::value(in, m_parameters.data(), out);
+
+        VectorType ret( imageDimension() );
+        for (unsigned i = 0; i < Evaluator::image_dimension; ++i)
+        {
+            ret[i] = out[i];
+        }
+        return ret;
+    }
+
+    VectorType operator() (const VectorType& vec, MatrixType& der) override
+    {
+        this->assert_vector_size(vec, dimension(), "GeneratedMap vec vector size mismatch (2)!");
+
+        ScalarType in[Evaluator::dimension];
+        ScalarType out[Evaluator::image_dimension];
+        ScalarType out_der[Evaluator::image_dimension * Evaluator::dimension];
+
+        load(vec, in);
+        Evaluator::derivative(in, m_parameters.data(), out, out_der);
+
+        VectorType ret( imageDimension() );
+        der = MatrixType( imageDimension(), dimension() );
+        for (unsigned i = 0; i < Evaluator::image_dimension; ++i)
+        {
+            ret[i] = out[i];
+
+            for (unsigned j = 0; j < Evaluator::dimension; ++j)
+            {
+                der[i][j] = out_der[i * Evaluator::dimension + j];
+            }
+        }
+        return ret;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Compute coeff[1], ..., coeff[order] of the solution of x' = f(x) starting at coeff[0]
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void computeODECoefficients(VectorType coeff[], size_type order)
+    {
+        static_assert(Evaluator::dimension == Evaluator::image_dimension, "Taylor coefficients of a map which is not a vector field!");
+
+        this->assert_vector_size(coeff[0], dimension(), "GeneratedMap coeff vector size mismatch!");
+
+        std::vector<ScalarType> coeffs((order + 1) * Evaluator::dimension);
+        for (unsigned i = 0; i < Evaluator::dimension; ++i)
+        {
+            coeffs.at(i) = coeff[0][i];
+        }
+
+        Evaluator::taylor(m_parameters.data(), coeffs.data(), order);
+
+        for (size_type k = 1; k <= order; ++k)
+        {
+            for (unsigned i = 0; i < Evaluator::dimension; ++i)
+            {
+                coeff[k][i] = coeffs.at(k * Evaluator::dimension + i);
+            }
+        }
+    }
+
+    unsigned dimension() const override
+    {
+        return Evaluator::dimension;
+    }
+
+    unsigned imageDimension() const override
+    {
+        return Evaluator::image_dimension;
+    }
+
+private:
+    static void load(const VectorType& vec, ScalarType* in)
+    {
+        for (unsigned i = 0; i < Evaluator::dimension; ++i)
+        {
+            in[i] = vec[i];
+        }
+    }
+
+    std::vector<ScalarType> m_parameters;
+};
+
+}
+}
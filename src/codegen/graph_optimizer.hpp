@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "expression_graph.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace Pcr3bpProof
+{
+namespace Codegen
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Optimization pass of a traced expression graph
+//! @details Rebuilds the graph from the outputs:
+//!
+//!           - operations not reachable from the outputs are dropped,
+//!           - structurally identical operations are merged (arguments of commutative operations are ordered),
+//!           - operations on constants are folded if the result is an exact double (so that the folded constant is
+//!             still a rigorous value when the evaluator is instantiated with intervals),
+//!           - identities (x + 0, x * 1, x * 0, x - x, x * x, x^1, x^2, ...) are simplified.
+//!
+//!          Outputs which are identically zero become constant nodes and cost nothing in the evaluators. Parameter-only
+//!          subexpressions are kept in the graph, the emitter evaluates them once per call outside of the recurrences.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class GraphOptimizer
+{
+public:
+    GraphOptimizer(const ExpressionGraph& graph, const std::vector<size_t>& outputs)
+        : m_mapping(graph.size(), s_none)
+    {
+        std::vector<bool> reachable(graph.size(), false);
+        for (size_t id : outputs)
+        {
+            reachable.at(id) = true;
+        }
+
+        for (size_t id = graph.size(); id-- > 0; )
+        {
+            const Operation& operation = graph.at(id);
+            if (reachable.at(id) && (operation.is_unary() || operation.is_binary()))
+            {
+                reachable.at(operation.lhs) = true;
+                if (operation.is_binary())
+                {
+                    reachable.at(operation.rhs) = true;
+                }
+            }
+        }
+
+        for (size_t id = 0; id < graph.size(); ++id)
+        {
+            if (reachable.at(id))
+            {
+                m_mapping.at(id) = rebuild(graph.at(id));
+            }
+        }
+
+        for (size_t id : outputs)
+        {
+            m_outputs.push_back(m_mapping.at(id));
+        }
+    }
+
+    const ExpressionGraph& get_graph() const noexcept
+    {
+        return m_graph;
+    }
+
+    const std::vector<size_t>& get_outputs() const noexcept
+    {
+        return m_outputs;
+    }
+
+private:
+    using Key = std::tuple<int, size_t, size_t, std::uint64_t, size_t>;
+
+    static constexpr size_t s_none = size_t(-1);
+
+    static std::uint64_t bits(double value)
+    {
+        std::uint64_t ret;
+        std::memcpy(&ret, &value, sizeof(ret));
+        return ret;
+    }
+
+    //! id of the operation in the optimized graph, merged with an identical one if present
+    size_t add(const Operation& operation)
+    {
+        const Key key { static_cast<int>(operation.kind), operation.lhs, operation.rhs, bits(operation.value), operation.index };
+
+        const auto it = m_known.find(key);
+        if (it != m_known.end())
+        {
+            return it->second;
+        }
+
+        const size_t id = m_graph.add(operation);
+        m_known.emplace(key, id);
+        return id;
+    }
+
+    size_t constant(double value)
+    {
+        Operation operation {};
+        operation.kind = Operation::Kind::Constant;
+        operation.value = value;
+        return add(operation);
+    }
+
+    size_t unary(Operation::Kind kind, size_t arg, double value = 0.0)
+    {
+        Operation operation {};
+        operation.kind = kind;
+        operation.lhs = arg;
+        operation.value = value;
+        return add(operation);
+    }
+
+    size_t binary(Operation::Kind kind, size_t lhs, size_t rhs)
+    {
+        if ((kind == Operation::Kind::Add || kind == Operation::Kind::Mul) && rhs < lhs)
+        {
+            std::swap(lhs, rhs);
+        }
+
+        Operation operation {};
+        operation.kind = kind;
+        operation.lhs = lhs;
+        operation.rhs = rhs;
+        return add(operation);
+    }
+
+    bool is_constant(size_t id, double value) const
+    {
+        const Operation& operation = m_graph.at(id);
+        return operation.kind == Operation::Kind::Constant && operation.value == value;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Fold an operation on constants, only if the double result is exact
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static bool fold(Operation::Kind kind, double a, double b, double& result)
+    {
+        switch (kind)
+        {
+            case Operation::Kind::Add:
+            case Operation::Kind::Sub:
+            {
+                const double c = (kind == Operation::Kind::Add) ? b : -b;
+                result = a + c;
+                // error-free transformation (two-sum)
+                const double z = result - a;
+                const double error = (a - (result - z)) + (c - z);
+                return std::isfinite(result) && error == 0.0;
+            }
+            case Operation::Kind::Mul:
+                result = a * b;
+                return std::isfinite(result) && std::fma(a, b, -result) == 0.0;
+            case Operation::Kind::Sqr:
+                result = a * a;
+                return std::isfinite(result) && std::fma(a, a, -result) == 0.0;
+            case Operation::Kind::Div:
+                result = a / b;
+                return b != 0.0 && std::isfinite(result) && std::fma(result, b, -a) == 0.0;
+            case Operation::Kind::Neg:
+                result = -a;
+                return true;
+            case Operation::Kind::Sqrt:
+                result = std::sqrt(a);
+                return a >= 0.0 && std::fma(result, result, -a) == 0.0;
+            default:
+                return false;
+        }
+    }
+
+    size_t rebuild(const Operation& source)
+    {
+        using Kind = Operation::Kind;
+
+        if (!source.is_unary() && !source.is_binary())
+        {
+            return add(source);
+        }
+
+        const size_t lhs = m_mapping.at(source.lhs);
+        const size_t rhs = source.is_binary() ? m_mapping.at(source.rhs) : s_none;
+
+        const Operation a = m_graph.at(lhs);
+        const bool constant_args = a.kind == Kind::Constant && (!source.is_binary() || m_graph.at(rhs).kind == Kind::Constant);
+
+        double folded = 0.0;
+        if (constant_args && fold(source.kind, a.value, source.is_binary() ? m_graph.at(rhs).value : 0.0, folded))
+        {
+            return constant(folded);
+        }
+
+        switch (source.kind)
+        {
+            case Kind::Add:
+                if (is_constant(lhs, 0.0)) return rhs;
+                if (is_constant(rhs, 0.0)) return lhs;
+                return binary(Kind::Add, lhs, rhs);
+            case Kind::Sub:
+                if (is_constant(rhs, 0.0)) return lhs;
+                if (is_constant(lhs, 0.0)) return unary(Kind::Neg, rhs);
+                if (lhs == rhs) return constant(0.0);
+                return binary(Kind::Sub, lhs, rhs);
+            case Kind::Mul:
+                if (is_constant(lhs, 0.0) || is_constant(rhs, 0.0)) return constant(0.0);
+                if (is_constant(lhs, 1.0)) return rhs;
+                if (is_constant(rhs, 1.0)) return lhs;
+                if (is_constant(lhs, -1.0)) return unary(Kind::Neg, rhs);
+                if (is_constant(rhs, -1.0)) return unary(Kind::Neg, lhs);
+                if (lhs == rhs) return unary(Kind::Sqr, lhs);
+                return binary(Kind::Mul, lhs, rhs);
+            case Kind::Div:
+                if (is_constant(rhs, 1.0)) return lhs;
+                if (is_constant(lhs, 0.0)) return constant(0.0);
+                return binary(Kind::Div, lhs, rhs);
+            case Kind::Neg:
+                if (a.kind == Kind::Neg) return a.lhs;
+                return unary(Kind::Neg, lhs);
+            case Kind::Pow:
+                if (source.value == 1.0) return lhs;
+                if (source.value == 2.0) return unary(Kind::Sqr, lhs);
+                if (source.value == 0.5) return unary(Kind::Sqrt, lhs);
+                return unary(Kind::Pow, lhs, source.value);
+            default:
+                return unary(source.kind, lhs, source.value);
+        }
+    }
+
+    ExpressionGraph m_graph {};
+    std::vector<size_t> m_mapping;
+    std::vector<size_t> m_outputs {};
+    std::map<Key, size_t> m_known {};
+};
+
+}
+}
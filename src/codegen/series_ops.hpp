@@ -0,0 +1,156 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace Pcr3bpProof
+{
+namespace Codegen
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Scalar square x^2
+//! @details Intervals are squared with sqr (found by argument dependent lookup), which is nonnegative and tighter than x*x
+//!          for intervals containing 0, so the generated evaluators enclose the same values as the CAPD maps.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+inline double square(double x)
+{
+    return x * x;
+}
+
+template<typename ScalarType>
+ScalarType square(const ScalarType& x)
+{
+    return sqr(x);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Scalar power x^exponent
+//! @details Integer and half-integer exponents (the only ones used by the map definitions) are evaluated with products and
+//!          a square root, which is both faster and tighter for intervals than exp(exponent * log(x)).
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename ScalarType>
+ScalarType power(const ScalarType& x, double exponent)
+{
+    using std::exp;
+    using std::log;
+    using std::sqrt;
+
+    const double doubled = 2.0 * exponent;
+    if (doubled != std::floor(doubled) || std::fabs(exponent) > 64.0)
+    {
+        return exp(ScalarType(exponent) * log(x));
+    }
+
+    const bool half = (std::fmod(doubled, 2.0) != 0.0);
+    const ScalarType base = half ? sqrt(x) : x;
+
+    unsigned count = static_cast<unsigned>(std::fabs(half ? doubled : exponent));
+
+    ScalarType ret(1.0);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        ret *= base;
+    }
+
+    return exponent < 0.0 ? ScalarType(1.0) / ret : ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Recurrences for the Taylor coefficients of elementary operations, used by the generated evaluators
+//! @details Series are arrays of normalized Taylor coefficients, every function returns the k-th coefficient of the result
+//!          given the coefficients of order <= k of the arguments (and the coefficients of order < k of the result).
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename ScalarType>
+struct SeriesOps
+{
+    static ScalarType mul(const ScalarType* a, const ScalarType* b, size_t k)
+    {
+        ScalarType ret(0.0);
+        for (size_t i = 0; i <= k; ++i)
+        {
+            ret += a[i] * b[k - i];
+        }
+        return ret;
+    }
+
+    static ScalarType sqr(const ScalarType* a, size_t k)
+    {
+        // symmetric terms are counted twice
+        ScalarType ret(0.0);
+        for (size_t i = 0; 2 * i < k; ++i)
+        {
+            ret += a[i] * a[k - i];
+        }
+        ret *= ScalarType(2.0);
+
+        if (k % 2 == 0)
+        {
+            ret += square(a[k / 2]);
+        }
+        return ret;
+    }
+
+    //! q = a / b
+    static ScalarType div(const ScalarType* a, const ScalarType* b, const ScalarType* q, size_t k)
+    {
+        ScalarType ret = a[k];
+        for (size_t i = 1; i <= k; ++i)
+        {
+            ret -= b[i] * q[k - i];
+        }
+        return ret / b[0];
+    }
+
+    //! q = c / b
+    static ScalarType scalar_div(const ScalarType& c, const ScalarType* b, const ScalarType* q, size_t k)
+    {
+        ScalarType ret = (k == 0) ? c : ScalarType(0.0);
+        for (size_t i = 1; i <= k; ++i)
+        {
+            ret -= b[i] * q[k - i];
+        }
+        return ret / b[0];
+    }
+
+    //! r = sqrt(a)
+    static ScalarType sqrt(const ScalarType* a, const ScalarType* r, size_t k)
+    {
+        using std::sqrt;
+
+        if (k == 0)
+        {
+            return sqrt(a[0]);
+        }
+
+        ScalarType ret = a[k];
+        for (size_t i = 1; i < k; ++i)
+        {
+            ret -= r[i] * r[k - i];
+        }
+        return ret / (ScalarType(2.0) * r[0]);
+    }
+
+    //! w = a^exponent, from a w' = exponent a' w
+    static ScalarType pow(const ScalarType* a, double exponent, const ScalarType* w, size_t k)
+    {
+        if (k == 0)
+        {
+            return power(a[0], exponent);
+        }
+
+        ScalarType ret(0.0);
+        for (size_t j = 0; j < k; ++j)
+        {
+            ret += (ScalarType(exponent) * ScalarType(double(k - j)) - ScalarType(double(j))) * a[k - j] * w[j];
+        }
+        return ret / (ScalarType(double(k)) * a[0]);
+    }
+};
+
+}
+}
@@ -0,0 +1,345 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "regularized_system.hpp"
+#include "regularized_taylor_kernel.hpp"
+
+#include "tools/simd_lanes.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace Pcr3bpProof
+{
+namespace Pcr3bp
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Non-rigorous Taylor integrator of the regularized PCR3BP (fixed energy) advancing Width orbits in lockstep
+//! @details The orbits of a batch share the computation of the Taylor coefficients, RegularizedTaylorKernel is instantiated
+//!          with Lanes<Width>, so every recurrence of the kernel is a vector operation. The step size is chosen per lane from
+//!          the last two Taylor coefficients, lanes that have reached the final time or the requested number of section
+//!          crossings are masked with zero steps until the whole batch is done.
+//!
+//!          Intended for exploration (parameter scans, initial guesses), not for the rigorous part of the proof.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<size_t Width>
+class BatchedRegularizedIntegrator
+{
+public:
+    static constexpr size_t dimension = 4;
+
+    using Lane = Lanes<Width>;
+    using Kernel = RegularizedTaylorKernel<Lane>;
+    using State = std::array<double, dimension>;
+
+    //! section { x : <normal, x - origin> = 0 }, crossed when <normal, x - origin> changes sign from negative to non-negative
+    struct Section
+    {
+        State origin {};
+        State normal {};
+    };
+
+    struct Crossing
+    {
+        double time { 0.0 };
+        State point {};
+    };
+
+    struct Orbit
+    {
+        State state {};
+        double time { 0.0 };
+        std::vector<Crossing> crossings {};
+
+        //! false if the orbit has been stopped after the maximal number of steps
+        bool completed { true };
+    };
+
+    struct Settings
+    {
+        unsigned order { 20 };
+        double tolerance { 1e-16 };
+        double max_step { 0.1 };
+        size_t max_steps { 1000000 };
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //!
+    //! @param mu_index index of mass at which the regularization takes place
+    //! @param direction +1.0 for the positive and -1.0 for the negative vector field
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    BatchedRegularizedIntegrator(
+        size_t mu_index,
+        const Pcr3bp::SetupParameters<RMap>& setup,
+        double direction,
+        double h,
+        Settings settings = {})
+            : m_kernel(typename Kernel::Parameters {
+                setup.get_mu(3-mu_index),
+                setup.get_x(mu_index),
+                RegularizedSystem<RMap>::get_epsilon(mu_index),
+                direction,
+                h })
+            , m_settings(settings)
+    {
+        if (m_settings.order < 2)
+        {
+            throw std::logic_error("BatchedRegularizedIntegrator order must be at least 2!");
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Integrate the orbits starting at the given points
+    //!
+    //! @param time integration time of every orbit
+    //! @param section if given, the crossings of the section are recorded
+    //! @param max_crossings if positive, an orbit is stopped at its max_crossings-th crossing (its state is then the
+    //!                      crossing point, as for a Poincare map)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    std::vector<Orbit> integrate(
+        const std::vector<State>& initial,
+        double time,
+        const std::optional<Section>& section = std::nullopt,
+        size_t max_crossings = 0)
+    {
+        std::vector<Orbit> ret(initial.size());
+
+        for (size_t first = 0; first < initial.size(); first += Width)
+        {
+            const size_t count = std::min(Width, initial.size() - first);
+            integrate_batch(initial.data() + first, ret.data() + first, count, time, section, max_crossings);
+        }
+
+        return ret;
+    }
+
+private:
+    void integrate_batch(
+        const State* initial,
+        Orbit* orbits,
+        size_t count,
+        double time,
+        const std::optional<Section>& section,
+        size_t max_crossings)
+    {
+        const unsigned order = m_settings.order;
+
+        std::array<State, Width> state {};
+        std::array<double, Width> elapsed {};
+        std::array<double, Width> g {};
+        std::array<bool, Width> active {};
+        std::array<size_t, Width> steps {};
+
+        for (size_t l = 0; l < Width; ++l)
+        {
+            // padding lanes repeat the last orbit and are inactive
+            state[l] = initial[std::min(l, count - 1)];
+            active[l] = l < count && time > 0.0;
+            g[l] = section ? section_value(*section, state[l]) : 0.0;
+
+            if (l < count)
+            {
+                orbits[l] = Orbit {};
+                orbits[l].state = state[l];
+            }
+        }
+
+        while (std::any_of(active.begin(), active.end(), [](bool a) { return a; }))
+        {
+            m_kernel.reset(order, 0);
+            for (size_t i = 0; i < dimension; ++i)
+            {
+                for (size_t l = 0; l < Width; ++l)
+                {
+                    m_kernel.coeff(i, 0)[l] = state[l][i];
+                }
+            }
+
+            m_kernel.compute();
+
+            Lane step(0.0);
+            std::array<bool, Width> last_step {};
+            for (size_t l = 0; l < Width; ++l)
+            {
+                if (active[l])
+                {
+                    const double remaining = time - elapsed[l];
+                    step[l] = std::min(choose_step(l), remaining);
+                    last_step[l] = (step[l] == remaining);
+                }
+            }
+
+            for (size_t l = 0; l < Width; ++l)
+            {
+                if (!active[l])
+                {
+                    continue;
+                }
+
+                const State next = evaluate(l, step[l]);
+
+                if (section)
+                {
+                    const double g_next = section_value(*section, next);
+                    if (g[l] < 0.0 && g_next >= 0.0)
+                    {
+                        const double t = locate_crossing(*section, l, step[l]);
+
+                        Crossing crossing { elapsed[l] + t, evaluate(l, t) };
+                        orbits[l].crossings.push_back(crossing);
+
+                        if (max_crossings > 0 && orbits[l].crossings.size() >= max_crossings)
+                        {
+                            orbits[l].state = crossing.point;
+                            orbits[l].time = crossing.time;
+                            active[l] = false;
+                            continue;
+                        }
+                    }
+                    g[l] = g_next;
+                }
+
+                state[l] = next;
+                elapsed[l] = last_step[l] ? time : elapsed[l] + step[l];
+                ++steps[l];
+
+                const bool finished = last_step[l];
+                const bool stalled = steps[l] >= m_settings.max_steps;
+                if (finished || stalled)
+                {
+                    orbits[l].state = state[l];
+                    orbits[l].time = elapsed[l];
+                    orbits[l].completed = finished;
+                    active[l] = false;
+                }
+            }
+        }
+    }
+
+    static double section_value(const Section& section, const State& x)
+    {
+        double ret = 0.0;
+        for (size_t i = 0; i < dimension; ++i)
+        {
+            ret += section.normal[i] * (x[i] - section.origin[i]);
+        }
+        return ret;
+    }
+
+    double coeff_norm(size_t l, size_t k)
+    {
+        double ret = 0.0;
+        for (size_t i = 0; i < dimension; ++i)
+        {
+            ret = std::max(ret, std::fabs(m_kernel.coeff(i, k)[l]));
+        }
+        return ret;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Step size of a lane such that the last two terms of the Taylor series are below the tolerance
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    double choose_step(size_t l)
+    {
+        const unsigned order = m_settings.order;
+
+        double ret = m_settings.max_step;
+        for (unsigned k = order - 1; k <= order; ++k)
+        {
+            const double norm = coeff_norm(l, k);
+            if (norm > 0.0)
+            {
+                ret = std::min(ret, std::pow(m_settings.tolerance / norm, 1.0 / k));
+            }
+        }
+        return ret;
+    }
+
+    //! value of the Taylor polynomial of lane l at t (Horner scheme)
+    State evaluate(size_t l, double t)
+    {
+        State ret {};
+        for (size_t i = 0; i < dimension; ++i)
+        {
+            double value = m_kernel.coeff(i, m_settings.order)[l];
+            for (size_t k = m_settings.order; k-- > 0; )
+            {
+                value = value * t + m_kernel.coeff(i, k)[l];
+            }
+            ret[i] = value;
+        }
+        return ret;
+    }
+
+    //! derivative of the Taylor polynomial of lane l at t
+    State evaluate_derivative(size_t l, double t)
+    {
+        State ret {};
+        for (size_t i = 0; i < dimension; ++i)
+        {
+            double value = m_settings.order * m_kernel.coeff(i, m_settings.order)[l];
+            for (size_t k = m_settings.order - 1; k > 0; --k)
+            {
+                value = value * t + k * m_kernel.coeff(i, k)[l];
+            }
+            ret[i] = value;
+        }
+        return ret;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Crossing time within the step [0, step] of lane l, Newton method safeguarded by bisection
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    double locate_crossing(const Section& section, size_t l, double step)
+    {
+        double lo = 0.0;
+        double hi = step;
+        double t = 0.5 * step;
+
+        for (unsigned iteration = 0; iteration < 100 && hi - lo > std::numeric_limits<double>::epsilon() * step; ++iteration)
+        {
+            const double value = section_value(section, evaluate(l, t));
+            if (value == 0.0)
+            {
+                return t;
+            }
+
+            if (value < 0.0)
+            {
+                lo = t;
+            }
+            else
+            {
+                hi = t;
+            }
+
+            const State derivative = evaluate_derivative(l, t);
+            double slope = 0.0;
+            for (size_t i = 0; i < dimension; ++i)
+            {
+                slope += section.normal[i] * derivative[i];
+            }
+
+            const double newton = (slope != 0.0) ? t - value / slope : lo - 1.0;
+            t = (newton > lo && newton < hi) ? newton : 0.5 * (lo + hi);
+        }
+
+        return hi;
+    }
+
+    Kernel m_kernel;
+    const Settings m_settings;
+};
+
+}
+}
@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "regularized_system.hpp"
+
+#include <optional>
+#include <stdexcept>
+
+namespace Pcr3bpProof
+{
+namespace Pcr3bp
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Reduction of the regularized PCR3BP (fixed energy) to the energy surface { H = 0 }
+//! @details Provides the charts of the energy surface adapted to a Poincare section and, for a given chart, the reduced
+//!          vector field in 3 dimensions, the lift to the 4 dimensional phase space and the projection back to the chart.
+//!
+//!          The chart is chosen so that the section { (x - o) . n = 0 } in the phase space corresponds to an affine section
+//!          in the chart coordinates. The component of the momentum perpendicular to (n3, n4) is recovered from the
+//!          Hamiltonian. Of its two roots the chart takes the one on which dH/dp . (-n4, n3) has the sign of the branch, so
+//!          the sign of dH/dp . (-n4, n3) has to be known on the whole source set, otherwise a point on the other root would be
+//!          lifted to a different point of the energy surface. The branch is chosen at the origins of the source and the
+//!          destination coordinate systems when the chart is created and has to be verified on every evaluated set with the
+//!          branch function (see EnergySurfacePoincareMap). Along the reduced trajectories the discriminant does not vanish,
+//!          since the Taylor coefficients of its square root are not defined at zero, so the branch is preserved.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+class EnergySurfaceReduction
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+    using VectorType = typename MapT::VectorType;
+
+    using Chart = typename RegularizedSystem<MapT>::EnergySurfaceChart;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //!
+    //! @param mu_index index of mass at which the regularization takes place
+    //! @param direction +1.0 for the positive and -1.0 for the negative vector field
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    EnergySurfaceReduction(size_t mu_index, const Pcr3bp::SetupParameters<MapT>& setup, ScalarType direction, ScalarType h)
+        : m_mu_index(mu_index)
+        , m_setup(setup)
+        , m_direction(direction)
+        , m_h(h)
+    {}
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Create chart adapted to the section through dst_origin perpendicular to dst_normal
+    //! @return Empty if the section does not depend on the momenta or if the momentum perpendicular to (n3, n4) cannot be
+    //!         recovered with the same branch at both origins
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    std::optional<Chart> create_chart(
+        const VectorType& src_origin,
+        const VectorType& dst_origin,
+        const VectorType& dst_normal) const
+    {
+        if (src_origin.dimension() != 4 || dst_origin.dimension() != 4 || dst_normal.dimension() != 4)
+        {
+            throw std::logic_error("EnergySurfaceReduction vector size mismatch!");
+        }
+
+        Chart chart {};
+        chart.n3 = dst_normal[2];
+        chart.n4 = dst_normal[3];
+        chart.offset = dst_origin[2]*chart.n3 + dst_origin[3]*chart.n4;
+
+        const ScalarType nu2 = chart.n3*chart.n3 + chart.n4*chart.n4;
+        if (!(nu2 > m_margin*m_margin * (dst_normal[0]*dst_normal[0] + dst_normal[1]*dst_normal[1] + nu2)))
+        {
+            return std::nullopt;
+        }
+
+        const int src_branch = get_branch(src_origin, chart);
+        const int dst_branch = get_branch(dst_origin, chart);
+
+        if (src_branch == 0 || src_branch != dst_branch)
+        {
+            return std::nullopt;
+        }
+
+        chart.branch = ScalarType(src_branch);
+        return chart;
+    }
+
+    //! vector field in the chart coordinates (u, v, w), dimension 3 -> 3
+    MapT create_vector_field(const Chart& chart) const
+    {
+        return RegularizedSystem<MapT>::createReducedVectorField3(m_mu_index, m_setup, m_direction, m_h, chart);
+    }
+
+    //! (u, v, w) -> (u, v, pu, pv), dimension 3 -> 4
+    MapT create_lift(const Chart& chart) const
+    {
+        return RegularizedSystem<MapT>::createEnergySurfaceLift(m_mu_index, m_setup, m_h, chart);
+    }
+
+    //! (u, v, pu, pv) -> branch * dH/dp . (-n4, n3), dimension 4 -> 1, positive on the points of the chart branch
+    MapT create_branch_function(const Chart& chart) const
+    {
+        return RegularizedSystem<MapT>::createEnergySurfaceBranchFunction(m_mu_index, m_setup, chart);
+    }
+
+    //! (u, v, pu, pv) -> (u, v, w), dimension 4 -> 3
+    MapT create_chart_map(const Chart& chart) const
+    {
+        return RegularizedSystem<MapT>::createEnergySurfaceChart(chart);
+    }
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Sign of dH/dp . (-n4, n3) at given point, 0 if the angle between dH/dp and (-n4, n3) is not separated from
+    //!        a right angle
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    int get_branch(const VectorType& point, const Chart& chart) const
+    {
+        const ScalarType x_i = m_setup.get_x(m_mu_index);
+
+        const ScalarType u = point[0];
+        const ScalarType v = point[1];
+        const ScalarType r2 = u*u + v*v;
+
+        const ScalarType ddpu = point[2] + 2.0*v*(r2 - x_i);
+        const ScalarType ddpv = point[3] - 2.0*u*(r2 + x_i);
+
+        const ScalarType derivative = -ddpu*chart.n4 + ddpv*chart.n3;
+        const ScalarType bound = m_margin*m_margin * (ddpu*ddpu + ddpv*ddpv) * (chart.n3*chart.n3 + chart.n4*chart.n4);
+
+        if (derivative*derivative > bound)
+        {
+            return derivative > 0.0 ? 1 : (derivative < 0.0 ? -1 : 0);
+        }
+
+        return 0;
+    }
+
+    size_t m_mu_index;
+    Pcr3bp::SetupParameters<MapT> m_setup;
+    ScalarType m_direction;
+    ScalarType m_h;
+
+    //! required separation (sine of the angle) of the section normal from the (u, v) plane and of dH/dp from (n3, n4)
+    static constexpr double m_margin { 1.0e-3 };
+};
+
+}
+}
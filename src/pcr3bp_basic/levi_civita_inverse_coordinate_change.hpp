@@ -6,97 +6,35 @@
 
 #include <capd_utils/capd/basic_types.hpp>
 #include <capd_utils/map_base.hpp>
+#include <tools/types.hpp>
 
 namespace Pcr3bpProof
 {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-//! @brief Inverse coordinate change (from standard to regularized)
-//! @details This coordinate change maps standard configuration space to fragment of regularized space for which u > 0
+//! @brief Builders of the pieces of the inverse coordinate change
+//! @details The piece f1, f2, f3 or f4 is chosen by the sign of y (and of x - xi if y = 0), g maps (u, v, px, py) to
+//!          regularized momenta. The types of the pieces are members, so the pieces can be replaced by maps with the same
+//!          definitions (see GeneratedLeviCivitaInverseCoordinateChangePieces).
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename MapT>
-class LeviCivitaInverseCoordinateChange : public CapdUtils::MapBase<MapT>
+class LeviCivitaInverseCoordinateChangePieces
 {
 public:
     using ScalarType = typename MapT::ScalarType;
-    using VectorType = typename MapT::VectorType;
-    using MatrixType = typename MapT::MatrixType;
-
-	LeviCivitaInverseCoordinateChange(ScalarType xi, bool append_h = true)
-        : m_xi(xi)
-        , m_dimension(append_h ? 5 : 4)
-        , m_f1(create_f1(xi, append_h))
-        , m_f2(create_f2(xi, append_h))
-        , m_f3(create_f3(xi, append_h))
-        , m_f4(create_f4(xi, append_h))
-        , m_g(create_g(append_h))
-	{}
-
-	VectorType operator()(const VectorType& x) override
-	{
-        this->assert_vector_size(x, m_dimension, "LeviCivitaInverseCoordinateChange x vector size mismatch (1)!");
-
-		if(x[1] > 0)
-        {
-            return m_g( m_f1(x) );
-        }
-		if(x[1] < 0)
-        {
-            return m_g( m_f2(x) );
-        }
-		if(x[0] >= m_xi)
-        {
-            return m_f3(x);
-        }
-		return m_f4(x);
-	}
 
-    VectorType operator()(const VectorType& x, MatrixType& mat) override
-	{
-        this->assert_vector_size(x, m_dimension, "LeviCivitaInverseCoordinateChange x vector size mismatch (2)!");
+    using F1 = MapT;
+    using F2 = MapT;
+    using F3 = MapT;
+    using F4 = MapT;
+    using G = MapT;
 
-		if(x[1] > 0)
-        {
-            MatrixType der1( m_f1.imageDimension(), m_f1.dimension() );
-            const VectorType x1 = m_f1(x, der1);
-
-            MatrixType der2 ( m_g.imageDimension(), m_g.dimension() );
-            const VectorType x2 = m_g(x1, der2);
-
-            mat = der2 * der1;
-            return x2;
-        }
-		if(x[1] < 0)
-        {
-            MatrixType der1( m_f2.imageDimension(), m_f2.dimension() );
-            const VectorType x1 = m_f2(x, der1);
-
-            MatrixType der2 ( m_g.imageDimension(), m_g.dimension() );
-            const VectorType x2 = m_g(x1, der2);
-
-            mat = der2 * der1;
-            return x2;
-        }
-		if(x[0] >= m_xi)
-        {
-            return m_f3(x, mat);
-        }
-
-		return m_f4(x, mat);
-	}
-
-    unsigned dimension() const noexcept override
-    {
-        return m_dimension;
-    }
-
-    unsigned imageDimension() const noexcept override
+    static unsigned dimension(bool append_h) noexcept
     {
-        return m_dimension;
+        return append_h ? 5 : 4;
     }
 
-private:
-    static CapdUtils::Node delta(CapdUtils::Node& x, CapdUtils::Node& y, CapdUtils::Node& xi)
+    static NodeType<MapT> delta(NodeType<MapT>& x, NodeType<MapT>& y, NodeType<MapT>& xi)
     {
         return sqrt( sqr(x-xi) + sqr(y) );
     }
@@ -104,9 +42,9 @@ private:
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //! @brief y > 0 => u > 0 and v > 0
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    MapT create_f1(ScalarType xi, bool append_h)
+    static MapT create_f1(ScalarType xi, bool append_h)
     {
-        using CapdUtils::Node;
+        using Node = NodeType<MapT>;
         auto func = [append_h](Node, Node in[], int, Node out[], int, Node param[], int)
         {
             Node& x = in[0];
@@ -127,7 +65,7 @@ private:
             }
         };
 
-        MapT map(func, m_dimension, m_dimension, 1);
+        MapT map(func, dimension(append_h), dimension(append_h), 1);
         map.setParameter(0, xi);
         return map;
     };
@@ -135,9 +73,9 @@ private:
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //! @brief y < 0 => u > 0 and v < 0
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    MapT create_f2(ScalarType xi, bool append_h)
+    static MapT create_f2(ScalarType xi, bool append_h)
     {
-        using CapdUtils::Node;
+        using Node = NodeType<MapT>;
         auto func = [append_h](Node, Node in[], int, Node out[], int, Node param[], int)
         {
             Node& x = in[0];
@@ -158,7 +96,7 @@ private:
             }
         };
 
-        MapT map(func, m_dimension, m_dimension, 1);
+        MapT map(func, dimension(append_h), dimension(append_h), 1);
         map.setParameter(0, xi);
         return map;
     };
@@ -166,9 +104,9 @@ private:
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //! @brief y = 0 and x >= xi => u^2 = x-xi and v = 0
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    MapT create_f3(ScalarType xi, bool append_h)
+    static MapT create_f3(ScalarType xi, bool append_h)
     {
-        using CapdUtils::Node;
+        using Node = NodeType<MapT>;
         auto func = [append_h](Node, Node in[], int, Node out[], int, Node param[], int)
         {
             Node& x = in[0];
@@ -190,7 +128,7 @@ private:
             }
         };
 
-        MapT map(func, m_dimension, m_dimension, 1);
+        MapT map(func, dimension(append_h), dimension(append_h), 1);
         map.setParameter(0, xi);
         return map;
     };
@@ -198,9 +136,9 @@ private:
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //! @brief y = 0 and x < xi => u = 0 and v^2 = xi-x
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    MapT create_f4(ScalarType xi, bool append_h)
+    static MapT create_f4(ScalarType xi, bool append_h)
     {
-        using CapdUtils::Node;
+        using Node = NodeType<MapT>;
         auto func = [append_h](Node, Node in[], int, Node out[], int, Node param[], int)
         {
             Node& x = in[0];
@@ -222,14 +160,14 @@ private:
             }
         };
 
-        MapT map(func, m_dimension, m_dimension, 1);
+        MapT map(func, dimension(append_h), dimension(append_h), 1);
         map.setParameter(0, xi);
         return map;
     };
 
-    MapT create_g(bool append_h)
+    static MapT create_g(bool append_h)
     {
-        using CapdUtils::Node;
+        using Node = NodeType<MapT>;
         auto func = [append_h](Node, Node in[], int, Node out[], int, Node param[], int)
         {
             Node& u = in[0];
@@ -249,18 +187,105 @@ private:
             }
         };
 
-        MapT map(func, m_dimension, m_dimension, 0);
+        MapT map(func, dimension(append_h), dimension(append_h), 0);
         return map;
     }
+};
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Inverse coordinate change (from standard to regularized)
+//! @details This coordinate change maps standard configuration space to fragment of regularized space for which u > 0
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT, typename PiecesT = LeviCivitaInverseCoordinateChangePieces<MapT>>
+class LeviCivitaInverseCoordinateChange : public CapdUtils::MapBase<MapT>
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+    using VectorType = typename MapT::VectorType;
+    using MatrixType = typename MapT::MatrixType;
+
+	LeviCivitaInverseCoordinateChange(ScalarType xi, bool append_h = true)
+        : m_xi(xi)
+        , m_dimension(PiecesT::dimension(append_h))
+        , m_f1(PiecesT::create_f1(xi, append_h))
+        , m_f2(PiecesT::create_f2(xi, append_h))
+        , m_f3(PiecesT::create_f3(xi, append_h))
+        , m_f4(PiecesT::create_f4(xi, append_h))
+        , m_g(PiecesT::create_g(append_h))
+	{}
+
+	VectorType operator()(const VectorType& x) override
+	{
+        this->assert_vector_size(x, m_dimension, "LeviCivitaInverseCoordinateChange x vector size mismatch (1)!");
+
+		if(x[1] > 0)
+        {
+            return m_g( m_f1(x) );
+        }
+		if(x[1] < 0)
+        {
+            return m_g( m_f2(x) );
+        }
+		if(x[0] >= m_xi)
+        {
+            return m_f3(x);
+        }
+		return m_f4(x);
+	}
+
+    VectorType operator()(const VectorType& x, MatrixType& mat) override
+	{
+        this->assert_vector_size(x, m_dimension, "LeviCivitaInverseCoordinateChange x vector size mismatch (2)!");
+
+		if(x[1] > 0)
+        {
+            MatrixType der1( m_f1.imageDimension(), m_f1.dimension() );
+            const VectorType x1 = m_f1(x, der1);
+
+            MatrixType der2 ( m_g.imageDimension(), m_g.dimension() );
+            const VectorType x2 = m_g(x1, der2);
+
+            mat = der2 * der1;
+            return x2;
+        }
+		if(x[1] < 0)
+        {
+            MatrixType der1( m_f2.imageDimension(), m_f2.dimension() );
+            const VectorType x1 = m_f2(x, der1);
+
+            MatrixType der2 ( m_g.imageDimension(), m_g.dimension() );
+            const VectorType x2 = m_g(x1, der2);
+
+            mat = der2 * der1;
+            return x2;
+        }
+		if(x[0] >= m_xi)
+        {
+            return m_f3(x, mat);
+        }
+
+		return m_f4(x, mat);
+	}
+
+    unsigned dimension() const noexcept override
+    {
+        return m_dimension;
+    }
+
+    unsigned imageDimension() const noexcept override
+    {
+        return m_dimension;
+    }
+
+private:
     ScalarType m_xi;
     const unsigned m_dimension;
 
-	MapT m_f1;
-    MapT m_f2;
-    MapT m_f3;
-    MapT m_f4;
-    MapT m_g;
+    typename PiecesT::F1 m_f1;
+    typename PiecesT::F2 m_f2;
+    typename PiecesT::F3 m_f3;
+    typename PiecesT::F4 m_f4;
+    typename PiecesT::G m_g;
 };
 
 }
@@ -6,6 +6,8 @@
 
 #include "setup_parameters.hpp"
 
+#include <utility>
+
 namespace Pcr3bpProof
 {
 namespace Pcr3bp
@@ -19,7 +21,24 @@ public:
     using VectorType = typename MapT::VectorType;
     using MatrixType = typename MapT::MatrixType;
 
-    using Node = CapdUtils::Node;
+    using Node = NodeType<MapT>;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Coordinates (u, v, w) on the energy surface { H = 0 } of the regularized system (fixed energy)
+    //! @details The momentum is split along n = (n3, n4) and k = (-n4, n3):
+    //!
+    //!     w = pu*n3 + pv*n4 - offset,
+    //!
+    //!          the component along k is eliminated with the Hamiltonian, which is quadratic in it. Of the two solutions the
+    //!          one with sign(dH/dp . k) == branch is taken, the chart is valid as long as dH/dp . k does not vanish.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct EnergySurfaceChart
+    {
+        ScalarType n3 {};
+        ScalarType n4 {};
+        ScalarType offset {};
+        ScalarType branch {};
+    };
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //! @brief Create extended Hamiltonian of PCR3BP in regularized coordinates
@@ -41,14 +60,7 @@ public:
             Node& pv = in[3];
             Node& h = in[4];
 
-            Node factor = (sqr(sqr(u)-sqr(v)+epsilon) + sqr(2*u*v))^(-1.0/2);
-
-            out[0] = Node(0);
-
-            out[0] += 2*(sqr(u)+sqr(v))*(v*pu - u*pv - 2*mu3_i*factor - 2*h);
-            out[0] -= 2*x_i*(v*pu+u*pv);
-            out[0] -= 4*mu_i;
-            out[0] += (sqr(pu) + sqr(pv)) / 2;
+            hamiltonian(out[0], mu_i, mu3_i, x_i, epsilon, h, u, v, pu, pv);
         };
 
         MapT map(func, 5, 1, 4);
@@ -79,14 +91,7 @@ public:
             Node& pu = in[2];
             Node& pv = in[3];
 
-            Node factor = (sqr(sqr(u)-sqr(v)+epsilon) + sqr(2*u*v))^(-1.0/2);
-
-            out[0] = Node(0);
-
-            out[0] += 2*(sqr(u)+sqr(v))*(v*pu - u*pv - 2*mu3_i*factor - 2*h);
-            out[0] -= 2*x_i*(v*pu+u*pv);
-            out[0] -= 4*mu_i;
-            out[0] += (sqr(pu) + sqr(pv)) / 2;
+            hamiltonian(out[0], mu_i, mu3_i, x_i, epsilon, h, u, v, pu, pv);
         };
 
         MapT map(func, 4, 1, 5);
@@ -213,6 +218,157 @@ public:
         return collision_condition;
     }
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! Create vector field of PCR3BP in regularized coordinates reduced to the energy surface { H = 0 }, in the coordinates
+    //! (u, v, w) of the given chart
+    //!
+    //! @param mu_index index of mass at which the regularization takes place
+    //! @param direction +1.0 for the positive and -1.0 for the negative vector field
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static MapT createReducedVectorField3(
+        size_t mu_index,
+        const Pcr3bp::SetupParameters<MapT>& setup,
+        ScalarType direction,
+        ScalarType h,
+        const EnergySurfaceChart& chart)
+    {
+        auto func = [](Node, Node in[], int, Node out[], int, Node param[], int)
+        {
+            Node& mu_i = param[0];
+            Node& mu3_i = param[1];
+            Node& x_i = param[2];
+            Node& epsilon = param[3];
+            Node& h = param[4];
+            Node& n3 = param[5];
+            Node& n4 = param[6];
+            Node& offset = param[7];
+            Node& branch = param[8];
+            Node& dir = param[9];
+
+            Node& u = in[0];
+            Node& v = in[1];
+            Node& w = in[2];
+
+            auto [pu, pv] = energySurfaceMomenta(mu_i, mu3_i, x_i, epsilon, h, n3, n4, offset, branch, u, v, w);
+
+            Node ddu {};
+            Node ddv {};
+
+            hamiltonianGradient(
+                ddu,
+                ddv,
+                out[0],
+                out[1],
+                mu3_i,
+                x_i,
+                epsilon,
+                h,
+                u,
+                v,
+                pu,
+                pv
+                );
+
+            out[0] *= dir;
+            out[1] *= dir;
+            out[2] = (-dir) * (ddu*n3 + ddv*n4);
+        };
+
+        MapT map(func, 3, 3, 10);
+        setEnergySurfaceParameters(map, mu_index, setup, h, chart);
+        map.setParameter(9, direction);
+        return map;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! Create map (u, v, w) -> (u, v, pu, pv) from the coordinates of the given chart to the energy surface { H = 0 }
+    //!
+    //! @param mu_index index of mass at which the regularization takes place
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static MapT createEnergySurfaceLift(
+        size_t mu_index,
+        const Pcr3bp::SetupParameters<MapT>& setup,
+        ScalarType h,
+        const EnergySurfaceChart& chart)
+    {
+        auto func = [](Node, Node in[], int, Node out[], int, Node param[], int)
+        {
+            Node& u = in[0];
+            Node& v = in[1];
+            Node& w = in[2];
+
+            auto [pu, pv] = energySurfaceMomenta(
+                param[0], param[1], param[2], param[3], param[4], param[5], param[6], param[7], param[8], u, v, w);
+
+            out[0] = u;
+            out[1] = v;
+            out[2] = pu;
+            out[3] = pv;
+        };
+
+        MapT map(func, 3, 4, 9);
+        setEnergySurfaceParameters(map, mu_index, setup, h, chart);
+        return map;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! Create map (u, v, pu, pv) -> (u, v, w) to the coordinates of the given chart (left inverse of the lift)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static MapT createEnergySurfaceChart(const EnergySurfaceChart& chart)
+    {
+        auto func = [](Node, Node in[], int, Node out[], int, Node param[], int)
+        {
+            out[0] = in[0];
+            out[1] = in[1];
+            out[2] = in[2]*param[0] + in[3]*param[1] - param[2];
+        };
+
+        MapT map(func, 4, 3, 3);
+        map.setParameter(0, chart.n3);
+        map.setParameter(1, chart.n4);
+        map.setParameter(2, chart.offset);
+        return map;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! Create map (u, v, pu, pv) -> branch * dH/dp . (-n4, n3), the point is on the branch of the given chart if the value is
+    //! positive (see EnergySurfaceChart)
+    //!
+    //! @param mu_index index of mass at which the regularization takes place
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static MapT createEnergySurfaceBranchFunction(
+        size_t mu_index,
+        const Pcr3bp::SetupParameters<MapT>& setup,
+        const EnergySurfaceChart& chart)
+    {
+        auto func = [](Node, Node in[], int, Node out[], int, Node param[], int)
+        {
+            Node& x_i = param[0];
+            Node& n3 = param[1];
+            Node& n4 = param[2];
+            Node& branch = param[3];
+
+            Node& u = in[0];
+            Node& v = in[1];
+            Node& pu = in[2];
+            Node& pv = in[3];
+
+            Node r2 = sqr(u) + sqr(v);
+
+            Node ddpu = pu + 2*v*(r2 - x_i);
+            Node ddpv = pv - 2*u*(r2 + x_i);
+
+            out[0] = branch * (ddpv*n3 - ddpu*n4);
+        };
+
+        MapT map(func, 4, 1, 4);
+        map.setParameter(0, setup.get_x(mu_index));
+        map.setParameter(1, chart.n3);
+        map.setParameter(2, chart.n4);
+        map.setParameter(3, chart.branch);
+        return map;
+    }
+
 private:
     static MapT createVectorFieldInternal(size_t mu_index, const Pcr3bp::SetupParameters<MapT>& setup, ScalarType direction, bool t_coordinate)
     {
@@ -249,11 +405,11 @@ private:
             out[2] *= (-dir);
             out[3] *= (-dir);
 
+            // h is constant along the solutions
             out[4] = Node(0);
 
             if (t_coordinate)
             {
-                Node& t = in[5];
                 out[5] = 4*(sqr(u)+sqr(v));
             }
         };
@@ -313,6 +469,87 @@ private:
         return map;
     }
 
+    static void setEnergySurfaceParameters(
+        MapT& map,
+        size_t mu_index,
+        const Pcr3bp::SetupParameters<MapT>& setup,
+        ScalarType h,
+        const EnergySurfaceChart& chart)
+    {
+        map.setParameter(0, setup.get_mu(mu_index));
+        map.setParameter(1, setup.get_mu(3-mu_index));
+        map.setParameter(2, setup.get_x(mu_index));
+        map.setParameter(3, get_epsilon(mu_index));
+        map.setParameter(4, h);
+        map.setParameter(5, chart.n3);
+        map.setParameter(6, chart.n4);
+        map.setParameter(7, chart.offset);
+        map.setParameter(8, chart.branch);
+    }
+
+    static void hamiltonian(
+        Node& out,
+        Node& mu_i,
+        Node& mu3_i,
+        Node& x_i,
+        Node& epsilon,
+        Node& h,
+        Node& u,
+        Node& v,
+        Node& pu,
+        Node& pv)
+    {
+        Node u2 = sqr(u);
+        Node v2 = sqr(v);
+
+        Node factor = (sqr(u2-v2+epsilon) + sqr(2*u*v))^(-1.0/2);
+
+        out = 2*(u2+v2)*(v*pu - u*pv - 2*mu3_i*factor - 2*h);
+        out -= 2*x_i*(v*pu+u*pv);
+        out -= 4*mu_i;
+        out += (sqr(pu) + sqr(pv)) / 2;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Momenta (pu, pv) of the point of the energy surface with chart coordinates (u, v, w)
+    //! @details With p0 = (w + offset) n / |n|^2 and p = p0 + tau k / |n|^2 the Hamiltonian is
+    //!
+    //!     H(u, v, p) = H(u, v, p0) + tau b / |n|^2 + tau^2 / (2 |n|^2),   b = dH/dp (u, v, p0) . k,
+    //!
+    //!          since it is quadratic in p with the unit quadratic form and p0 . k = 0. The branch selects the root tau.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static std::pair<Node, Node> energySurfaceMomenta(
+        Node& mu_i,
+        Node& mu3_i,
+        Node& x_i,
+        Node& epsilon,
+        Node& h,
+        Node& n3,
+        Node& n4,
+        Node& offset,
+        Node& branch,
+        Node& u,
+        Node& v,
+        Node& w)
+    {
+        Node nu2 = sqr(n3) + sqr(n4);
+        Node s = w + offset;
+
+        Node pu0 = s*n3 / nu2;
+        Node pv0 = s*n4 / nu2;
+
+        Node c {};
+        hamiltonian(c, mu_i, mu3_i, x_i, epsilon, h, u, v, pu0, pv0);
+
+        // p0 + (2v(r^2 - x_i), -2u(r^2 + x_i)) is the gradient of H with respect to p at p0, p0 . k = 0
+        Node r2 = sqr(u) + sqr(v);
+        Node b = -2*v*(r2 - x_i)*n4 - 2*u*(r2 + x_i)*n3;
+
+        Node tau = branch*sqrt(sqr(b) - 2*c*nu2) - b;
+
+        return { pu0 - tau*n4 / nu2, pv0 + tau*n3 / nu2 };
+    }
+
     static void hamiltonianGradient(
         Node& ddu,
         Node& ddv,
@@ -327,19 +564,25 @@ private:
         Node& pu,
         Node& pv)
     {
-        ddpu = pu + 2*v*(sqr(u) + sqr(v) - x_i);
-        ddpv = pv - 2*u*(sqr(u) + sqr(v) + x_i);
+        // shared subexpressions are created once, so that they are single nodes of the map
+        Node u2 = sqr(u);
+        Node v2 = sqr(v);
+        Node r2 = u2 + v2;
+
+        ddpu = pu + 2*v*(r2 - x_i);
+        ddpv = pv - 2*u*(r2 + x_i);
 
-        Node den = ( sqr(sqr(u)-sqr(v)+epsilon) + sqr(2*u*v) )^(-3.0/2);
+        Node h2 = 2*h;
+        Node den = 8*mu3_i * ( ( sqr(u2-v2+epsilon) + sqr(2*u*v) )^(-3.0/2) );
 
-        ddu = 4*u*(2*h-v*pu);
-        ddu += 2*pv*(x_i+3*sqr(u)+sqr(v));
-        ddu += 8*u*mu3_i*(1+epsilon*(sqr(u)-3*sqr(v))) * den;
+        ddu = 4*u*(h2-v*pu);
+        ddu += 2*pv*(x_i+3*u2+v2);
+        ddu += u*(1+epsilon*(u2-3*v2)) * den;
         ddu *= -1;
 
-        ddv = 4*v*(2*h+u*pv);
-        ddv += 2*pu*(x_i-3*sqr(v)-sqr(u));
-        ddv += 8*v*mu3_i*(1-epsilon*(sqr(v)-3*sqr(u))) * den;
+        ddv = 4*v*(h2+u*pv);
+        ddv += 2*pu*(x_i-3*v2-u2);
+        ddv += v*(1-epsilon*(v2-3*u2)) * den;
         ddv *= -1;
     }
 };
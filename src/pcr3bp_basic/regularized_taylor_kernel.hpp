@@ -0,0 +1,297 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace Pcr3bpProof
+{
+namespace Pcr3bp
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Taylor coefficients of solutions of the regularized PCR3BP vector field (fixed energy)
+//! @details Computes the normalized Taylor coefficients x_k = x^{(k)}(0) / k! of the solution of x' = f(x), where f is the
+//!          vector field created by RegularizedSystem::createPositiveVectorField4 / createNegativeVectorField4, together with
+//!          the coefficients of the solution of the variational equation V' = Df(x) V.
+//!
+//!          Instead of interpreting the expression tree of the vector field, the coefficients are computed directly with the
+//!          recurrences of automatic differentiation: every intermediate expression of the field is a series whose k-th
+//!          coefficient is obtained from the coefficients of order <= k of its arguments. The only non-polynomial term
+//!          w = s^{-3/2}, s = (u^2 - v^2 + epsilon)^2 + (2uv)^2, satisfies s w' = -3/2 s' w, which gives
+//!
+//!           w_k = 1 / (k s_0) \sum_{j=0}^{k-1} (-3/2 (k-j) - j) s_{k-j} w_j.
+//!
+//!          The kernel is generic in the scalar type, so it is used both in interval and in floating point computations.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename ScalarType>
+class RegularizedTaylorKernel
+{
+public:
+    struct Parameters
+    {
+        ScalarType mu3_i {};
+        ScalarType x_i {};
+        ScalarType epsilon {};
+        ScalarType direction {};
+        ScalarType h {};
+    };
+
+    static constexpr size_t dimension = 4;
+
+    explicit RegularizedTaylorKernel(const Parameters& parameters) : m_parameters(parameters)
+    {}
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Prepare buffers for coefficients up to given order
+    //!
+    //! @param direction_count number of columns of the variational matrix (0 if the variational equation is not solved)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void reset(size_t order, size_t direction_count)
+    {
+        m_order = order;
+        m_direction_count = direction_count;
+
+        m_coeffs.assign(SeriesCount * (order + 1), ScalarType(0.0));
+        m_dcoeffs.assign(SeriesCount * (order + 1) * direction_count, ScalarType(0.0));
+    }
+
+    const Parameters& get_parameters() const noexcept
+    {
+        return m_parameters;
+    }
+
+    ScalarType& coeff(size_t i, size_t k)
+    {
+        return m_coeffs[index(i, k)];
+    }
+
+    ScalarType& dcoeff(size_t i, size_t k, size_t j)
+    {
+        return m_dcoeffs[dindex(i, k, j)];
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Compute coefficients of order 1, ..., order from the coefficients (and variational matrix) of order 0
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void compute()
+    {
+        for (size_t k = 0; k < m_order; ++k)
+        {
+            compute_auxiliary(k);
+
+            const ScalarType factor = ScalarType(1.0) / ScalarType(double(k + 1));
+
+            for (size_t i = 0; i < dimension; ++i)
+            {
+                coeff(i, k + 1) = field(i, k) * factor;
+            }
+
+            for (size_t j = 0; j < m_direction_count; ++j)
+            {
+                for (size_t i = 0; i < dimension; ++i)
+                {
+                    dcoeff(i, k + 1, j) = dfield(i, k, j) * factor;
+                }
+            }
+        }
+    }
+
+private:
+    enum Series : size_t
+    {
+        U, V, PU, PV,
+        UU, VV, UV, R, VR, UR, A, AA, UV2, S, W, UVPU, UVPV, T1, T2, Q1, Q2, B1, B2, UB1, VB2, C1, C2, C1W, C2W,
+        SeriesCount
+    };
+
+    size_t index(size_t i, size_t k) const noexcept
+    {
+        return i * (m_order + 1) + k;
+    }
+
+    size_t dindex(size_t i, size_t k, size_t j) const noexcept
+    {
+        return (i * (m_order + 1) + k) * m_direction_count + j;
+    }
+
+    ScalarType c(size_t i, size_t k) const
+    {
+        return m_coeffs[index(i, k)];
+    }
+
+    ScalarType dc(size_t i, size_t k, size_t j) const
+    {
+        return m_dcoeffs[dindex(i, k, j)];
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Coefficient k of the product of series a and b (and its derivatives)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void product(size_t ret, size_t a, size_t b, size_t k)
+    {
+        ScalarType sum(0.0);
+        for (size_t l = 0; l <= k; ++l)
+        {
+            sum += c(a, l) * c(b, k - l);
+        }
+        coeff(ret, k) = sum;
+
+        for (size_t j = 0; j < m_direction_count; ++j)
+        {
+            ScalarType dsum(0.0);
+            for (size_t l = 0; l <= k; ++l)
+            {
+                dsum += dc(a, l, j) * c(b, k - l) + c(a, l) * dc(b, k - l, j);
+            }
+            dcoeff(ret, k, j) = dsum;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Coefficient k of the series alpha * a + beta * b (and its derivatives)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void linear(size_t ret, const ScalarType& alpha, size_t a, const ScalarType& beta, size_t b, size_t k)
+    {
+        coeff(ret, k) = alpha * c(a, k) + beta * c(b, k);
+
+        for (size_t j = 0; j < m_direction_count; ++j)
+        {
+            dcoeff(ret, k, j) = alpha * dc(a, k, j) + beta * dc(b, k, j);
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Coefficient k of the series s^{-3/2} (and its derivatives)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void power_minus_three_halves(size_t ret, size_t s, size_t k)
+    {
+        using std::sqrt;
+
+        const ScalarType alpha(-1.5);
+        const ScalarType s0 = c(s, 0);
+
+        if (k == 0)
+        {
+            const ScalarType w0 = ScalarType(1.0) / (s0 * sqrt(s0));
+            coeff(ret, 0) = w0;
+
+            for (size_t j = 0; j < m_direction_count; ++j)
+            {
+                dcoeff(ret, 0, j) = alpha * w0 * dc(s, 0, j) / s0;
+            }
+            return;
+        }
+
+        const ScalarType ks0 = ScalarType(double(k)) * s0;
+
+        ScalarType sum(0.0);
+        for (size_t l = 0; l < k; ++l)
+        {
+            sum += (alpha * ScalarType(double(k - l)) - ScalarType(double(l))) * c(s, k - l) * c(ret, l);
+        }
+        const ScalarType wk = sum / ks0;
+        coeff(ret, k) = wk;
+
+        for (size_t j = 0; j < m_direction_count; ++j)
+        {
+            ScalarType dsum(0.0);
+            for (size_t l = 0; l < k; ++l)
+            {
+                dsum += (alpha * ScalarType(double(k - l)) - ScalarType(double(l)))
+                    * (dc(s, k - l, j) * c(ret, l) + c(s, k - l) * dc(ret, l, j));
+            }
+            dcoeff(ret, k, j) = (dsum - ScalarType(double(k)) * dc(s, 0, j) * wk) / ks0;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Coefficient k of all intermediate series of the vector field
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void compute_auxiliary(size_t k)
+    {
+        const ScalarType one(1.0);
+        const ScalarType& epsilon = m_parameters.epsilon;
+
+        product(UU, U, U, k);
+        product(VV, V, V, k);
+        product(UV, U, V, k);
+
+        linear(R, one, UU, one, VV, k);
+        product(VR, V, R, k);
+        product(UR, U, R, k);
+
+        // s = (u^2 - v^2 + epsilon)^2 + 4 (uv)^2
+        linear(A, one, UU, -one, VV, k);
+        if (k == 0)
+        {
+            coeff(A, 0) += epsilon;
+        }
+        product(AA, A, A, k);
+        product(UV2, UV, UV, k);
+        linear(S, one, AA, ScalarType(4.0), UV2, k);
+        power_minus_three_halves(W, S, k);
+
+        product(UVPU, UV, PU, k);
+        product(UVPV, UV, PV, k);
+
+        linear(T1, ScalarType(3.0), UU, one, VV, k);
+        linear(T2, one, UU, ScalarType(3.0), VV, k);
+        product(Q1, PV, T1, k);
+        product(Q2, PU, T2, k);
+
+        // c1 = u (1 + epsilon (u^2 - 3 v^2)), c2 = v (1 - epsilon (v^2 - 3 u^2))
+        linear(B1, one, UU, ScalarType(-3.0), VV, k);
+        linear(B2, one, VV, ScalarType(-3.0), UU, k);
+        product(UB1, U, B1, k);
+        product(VB2, V, B2, k);
+        linear(C1, one, U, epsilon, UB1, k);
+        linear(C2, one, V, -epsilon, VB2, k);
+        product(C1W, C1, W, k);
+        product(C2W, C2, W, k);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Coefficient k of the i-th component of the vector field
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ScalarType field(size_t i, size_t k) const
+    {
+        return m_parameters.direction * field_terms(i, [this, k](size_t series) { return c(series, k); });
+    }
+
+    ScalarType dfield(size_t i, size_t k, size_t j) const
+    {
+        return m_parameters.direction * field_terms(i, [this, k, j](size_t series) { return dc(series, k, j); });
+    }
+
+    template<typename GetT>
+    ScalarType field_terms(size_t i, GetT get) const
+    {
+        const ScalarType& mu3_i = m_parameters.mu3_i;
+        const ScalarType& x_i = m_parameters.x_i;
+        const ScalarType& h = m_parameters.h;
+
+        switch (i)
+        {
+            case 0: return get(PU) + 2.0 * get(VR) - 2.0 * x_i * get(V);
+            case 1: return get(PV) - 2.0 * get(UR) - 2.0 * x_i * get(U);
+            case 2: return 8.0 * h * get(U) - 4.0 * get(UVPU) + 2.0 * x_i * get(PV) + 2.0 * get(Q1) + 8.0 * mu3_i * get(C1W);
+            default: return 8.0 * h * get(V) + 4.0 * get(UVPV) + 2.0 * x_i * get(PU) - 2.0 * get(Q2) + 8.0 * mu3_i * get(C2W);
+        }
+    }
+
+    const Parameters m_parameters;
+
+    size_t m_order { 0 };
+    size_t m_direction_count { 0 };
+
+    std::vector<ScalarType> m_coeffs {};
+    std::vector<ScalarType> m_dcoeffs {};
+};
+
+}
+}
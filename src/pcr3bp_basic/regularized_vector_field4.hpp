@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "regularized_system.hpp"
+#include "regularized_taylor_kernel.hpp"
+
+#include "tools/sse_interval.hpp"
+
+#include <optional>
+#include <type_traits>
+
+namespace Pcr3bpProof
+{
+namespace Pcr3bp
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Regularized PCR3BP vector field (fixed energy) with hand-coded Taylor coefficients
+//! @details The object is the map created by RegularizedSystem::createPositiveVectorField4 / createNegativeVectorField4, so
+//!          it is evaluated (and differentiated) as before and can be passed wherever the vector field map is expected.
+//!          The Taylor coefficient computation used by the CAPD solvers, i.e. computeODECoefficients for the solution and
+//!          for the first order variational equation, is shadowed by RegularizedTaylorKernel. Solvers instantiated with this
+//!          type (rather than with MapT) use the kernel, higher order jets are still computed by MapT.
+//!
+//!          The parameters of the field are fixed at construction. For CAPD intervals the kernel runs with CAPD interval
+//!          arithmetic unless SseInterval is selected (PCR3BP_INTERVAL_KERNEL=sse).
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+class RegularizedVectorField4 : public MapT
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+    using VectorType = typename MapT::VectorType;
+    using MatrixType = typename MapT::MatrixType;
+    using size_type = typename MatrixType::size_type;
+
+    using Kernel = RegularizedTaylorKernel<ScalarType>;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //!
+    //! @param mu_index index of mass at which the regularization takes place
+    //! @param direction +1.0 for the positive and -1.0 for the negative vector field
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    RegularizedVectorField4(size_t mu_index, const Pcr3bp::SetupParameters<MapT>& setup, ScalarType direction, ScalarType h)
+        : MapT(direction > 0.0 ?
+            RegularizedSystem<MapT>::createPositiveVectorField4(mu_index, setup, h) :
+            RegularizedSystem<MapT>::createNegativeVectorField4(mu_index, setup, h))
+        , m_kernel(typename Kernel::Parameters {
+            setup.get_mu(3-mu_index),
+            setup.get_x(mu_index),
+            RegularizedSystem<MapT>::get_epsilon(mu_index),
+            direction,
+            h })
+    {}
+
+    using MapT::computeODECoefficients;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Compute coeff[1], ..., coeff[order] of the solution starting at coeff[0]
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void computeODECoefficients(VectorType coeff[], size_type order)
+    {
+        compute(coeff, nullptr, order);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Compute coefficients of the solution and of the variational equation starting at coeff[0] and dcoeff[0]
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void computeODECoefficients(VectorType coeff[], MatrixType dcoeff[], size_type order)
+    {
+        compute(coeff, dcoeff, order);
+    }
+
+private:
+    void compute(VectorType coeff[], MatrixType dcoeff[], size_type order)
+    {
+#if PCR3BP_SSE_INTERVAL_AVAILABLE
+        if constexpr (std::is_same<ScalarType, Interval>::value)
+        {
+            if (m_sse_kernel)
+            {
+                auto to_sse = [](const ScalarType& x) { return SseInterval(x.leftBound(), x.rightBound()); };
+                auto from_sse = [](const SseInterval& x) { return ScalarType(x.lower(), x.upper()); };
+
+                // the conversions are exact, the kernel itself requires the downward rounding
+                load(*m_sse_kernel, coeff, dcoeff, order, to_sse);
+                {
+                    const DownwardRounding rounding {};
+                    m_sse_kernel->compute();
+                }
+                store(*m_sse_kernel, coeff, dcoeff, order, from_sse);
+                return;
+            }
+        }
+#endif
+
+        auto identity = [](const ScalarType& x) { return x; };
+
+        load(m_kernel, coeff, dcoeff, order, identity);
+        m_kernel.compute();
+        store(m_kernel, coeff, dcoeff, order, identity);
+    }
+
+    template<typename KernelT, typename ConvertT>
+    void load(KernelT& kernel, const VectorType coeff[], const MatrixType dcoeff[], size_type order, ConvertT convert)
+    {
+        this->assert_dimension(coeff[0]);
+
+        const size_t direction_count = dcoeff ? dcoeff[0].numberOfColumns() : 0;
+        kernel.reset(order, direction_count);
+
+        for (size_t i = 0; i < Kernel::dimension; ++i)
+        {
+            kernel.coeff(i, 0) = convert(coeff[0][i]);
+
+            for (size_t j = 0; j < direction_count; ++j)
+            {
+                kernel.dcoeff(i, 0, j) = convert(dcoeff[0][i][j]);
+            }
+        }
+    }
+
+    template<typename KernelT, typename ConvertT>
+    void store(KernelT& kernel, VectorType coeff[], MatrixType dcoeff[], size_type order, ConvertT convert)
+    {
+        const size_t direction_count = dcoeff ? dcoeff[0].numberOfColumns() : 0;
+
+        for (size_type k = 1; k <= order; ++k)
+        {
+            for (size_t i = 0; i < Kernel::dimension; ++i)
+            {
+                coeff[k][i] = convert(kernel.coeff(i, k));
+
+                for (size_t j = 0; j < direction_count; ++j)
+                {
+                    dcoeff[k][i][j] = convert(kernel.dcoeff(i, k, j));
+                }
+            }
+        }
+    }
+
+    void assert_dimension(const VectorType& vec) const
+    {
+        if (vec.dimension() != Kernel::dimension)
+        {
+            throw std::logic_error("RegularizedVectorField4 vector size mismatch!");
+        }
+    }
+
+    Kernel m_kernel;
+
+#if PCR3BP_SSE_INTERVAL_AVAILABLE
+    using SseKernel = RegularizedTaylorKernel<SseInterval>;
+
+    //! interval kernel with SSE arithmetic, used for CAPD intervals if selected (see use_sse_intervals)
+    std::optional<SseKernel> m_sse_kernel
+    {
+        [this]() -> std::optional<SseKernel>
+        {
+            if constexpr (std::is_same<ScalarType, Interval>::value)
+            {
+                if (use_sse_intervals())
+                {
+                    auto to_sse = [](const ScalarType& x) { return SseInterval(x.leftBound(), x.rightBound()); };
+
+                    const typename Kernel::Parameters& p = m_kernel.get_parameters();
+                    return SseKernel(typename SseKernel::Parameters {
+                        to_sse(p.mu3_i), to_sse(p.x_i), to_sse(p.epsilon), to_sse(p.direction), to_sse(p.h) });
+                }
+            }
+            return std::nullopt;
+        }()
+    };
+#endif
+};
+
+}
+}
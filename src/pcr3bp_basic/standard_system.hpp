@@ -24,7 +24,7 @@ public:
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     static MapT createHamiltonian(const Pcr3bp::SetupParameters<MapT>& setup, ScalarType h0 = ScalarType(0.0))
     {
-        using CapdUtils::Node;
+        using Node = NodeType<MapT>;
 
         auto func = [](Node, Node in[], int, Node out[], int, Node param[], int)
         {
@@ -73,7 +73,7 @@ public:
 private:
     static MapT createVectorFieldInternal(const Pcr3bp::SetupParameters<MapT>& setup, bool h_coordinate, ScalarType direction)
 	{
-        using CapdUtils::Node;
+        using Node = NodeType<MapT>;
 
         auto func = [h_coordinate](Node, Node in[], int, Node out[], int, Node param[], int)
         {
@@ -91,15 +91,19 @@ private:
             out[0] = dir * (px + y);
             out[1] = dir * (py - x);
 
-            Node invr_1 = mu1*( (sqr(x-xi1)+sqr(y))^(-3.0/2) );
-		    Node invr_2 = mu2*( (sqr(x-xi2)+sqr(y))^(-3.0/2) );
+            Node x1 = x - xi1;
+            Node x2 = x - xi2;
+            Node y2 = sqr(y);
 
-            out[2] = dir * ( py - (x-xi1) * invr_1 - (x-xi2) * invr_2 );
+            Node invr_1 = mu1*( (sqr(x1)+y2)^(-3.0/2) );
+            Node invr_2 = mu2*( (sqr(x2)+y2)^(-3.0/2) );
+
+            out[2] = dir * ( py - x1 * invr_1 - x2 * invr_2 );
             out[3] = dir * (-px - y * (invr_1 + invr_2) );
 
+            // h is constant along the solutions
             if (h_coordinate)
             {
-                Node& h = in[4];
                 out[4] = Node(0.0);
             }
         };
@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "tools/test_tools.hpp"
+
+#include <capd_utils/timemap_wrapper.hpp>
+
+#include "pcr3bp_reg_basic_objects.hpp"
+#include "pcr3bp_basic/batched_regularized_integrator.hpp"
+
+#include <cmath>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Consistency check of the batched integrator with the CAPD timemap, for final states and for section crossings
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_batched_regularized_integrator, timemap_and_crossings)
+{
+    using namespace Pcr3bpProof;
+
+    using Integrator = Pcr3bp::BatchedRegularizedIntegrator<4>;
+
+    Pcr3bp::RegBasicObjects<RMap> basic_objects {};
+
+    RMap vector_field = Pcr3bp::RegularizedSystem<RMap>::createPositiveVectorField4(2, basic_objects.m_setup, basic_objects.m_h0);
+    CapdUtils::TimemapWrapper<RMap> timemap { vector_field, 0.0, basic_objects.m_order };
+
+    Integrator integrator { 2, basic_objects.m_setup, +1.0, basic_objects.m_h0 };
+
+    // 6 orbits, so that the second batch is padded
+    const RVector intermediate_point = basic_objects.m_parameters.get_intermediate_point();
+    std::vector<Integrator::State> initial {};
+    for (int i = 0; i < 6; ++i)
+    {
+        initial.push_back({ intermediate_point[0], intermediate_point[1], intermediate_point[2] + 1e-4 * i, intermediate_point[3] });
+    }
+
+    auto max_difference = [](const Integrator::State& state, const RVector& reference)
+    {
+        double ret = 0.0;
+        for (size_t i = 0; i < Integrator::dimension; ++i)
+        {
+            ret = std::max(ret, std::fabs(state[i] - reference[i]));
+        }
+        return ret;
+    };
+
+    auto to_vector = [](const Integrator::State& state)
+    {
+        return RVector{ state[0], state[1], state[2], state[3] };
+    };
+
+    const double time = 0.5;
+    const std::vector<Integrator::Orbit> orbits = integrator.integrate(initial, time);
+
+    ASSERT_EQ(orbits.size(), initial.size());
+    for (size_t i = 0; i < initial.size(); ++i)
+    {
+        timemap.set_time(time);
+        EXPECT_TRUE(orbits.at(i).completed);
+        EXPECT_EQ(orbits.at(i).time, time);
+        EXPECT_LT(max_difference(orbits.at(i).state, timemap(to_vector(initial.at(i)))), 1e-11);
+    }
+
+    const Integrator::Section section { { 0.0, 0.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0, 0.0 } };
+    const std::vector<Integrator::Orbit> returns = integrator.integrate(initial, 2 * basic_objects.m_lyapunov_orbit_period, section, 1);
+
+    for (size_t i = 0; i < initial.size(); ++i)
+    {
+        const Integrator::Orbit& orbit = returns.at(i);
+
+        ASSERT_EQ(orbit.crossings.size(), 1u);
+        EXPECT_LT(std::fabs(orbit.state[1]), 1e-12);
+
+        timemap.set_time(orbit.time);
+        EXPECT_LT(max_difference(orbit.state, timemap(to_vector(initial.at(i)))), 1e-10);
+    }
+}
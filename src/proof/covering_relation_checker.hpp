@@ -5,14 +5,127 @@
 #pragma once
 
 #include "tools/test_tools.hpp"
+#include "tools/parallel_executor.hpp"
+#include "tools/work_stealing_scheduler.hpp"
 #include <capd_utils/c1_map.hpp>
 
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
 namespace Pcr3bpProof
 {
 
 const Interval I = { -1.0, +1.0 };
 const IVector N = { I, I };
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Parameters of the subdivision mode of the covering relation check
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct CoveringRelationSubdivision
+{
+    //! Number of parts into which each side of N is split (1 means no subdivision)
+    unsigned grid_size { 1 };
+
+    //! Number of threads on which the sub-boxes are evaluated
+    unsigned worker_count { 1 };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Read grid size from PCR3BP_SUBDIVISION environment variable (no subdivision if not set)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static CoveringRelationSubdivision from_environment()
+    {
+        CoveringRelationSubdivision ret {};
+
+        if (const char* env = std::getenv("PCR3BP_SUBDIVISION"))
+        {
+            const unsigned long value = std::strtoul(env, nullptr, 10);
+            if (value > 0)
+            {
+                ret.grid_size = static_cast<unsigned>(value);
+            }
+        }
+
+        ret.worker_count = ParallelExecutor::get_default_worker_count();
+        return ret;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Parameters of the adaptive refinement mode of the covering relation check
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct CoveringRelationRefinement
+{
+    //! Maximal number of bisections of a part of N (0 means no adaptive refinement)
+    unsigned max_depth { 0 };
+
+    //! Parts wider than this are refined even if they satisfy the covering conditions
+    double width_budget { 2.0 };
+
+    //! Number of threads on which the parts are evaluated
+    unsigned worker_count { 1 };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Read parameters from PCR3BP_REFINEMENT_DEPTH and PCR3BP_REFINEMENT_WIDTH environment variables
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static CoveringRelationRefinement from_environment()
+    {
+        CoveringRelationRefinement ret {};
+
+        if (const char* env = std::getenv("PCR3BP_REFINEMENT_DEPTH"))
+        {
+            ret.max_depth = static_cast<unsigned>(std::strtoul(env, nullptr, 10));
+        }
+
+        if (const char* env = std::getenv("PCR3BP_REFINEMENT_WIDTH"))
+        {
+            const double value = std::strtod(env, nullptr);
+            if (value > 0.0)
+            {
+                ret.width_budget = value;
+            }
+        }
+
+        ret.worker_count = ParallelExecutor::get_default_worker_count();
+        return ret;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Statistics of the adaptive refinement of a single covering relation check
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct CoveringRelationRefinementReport
+{
+    //! Number of final sub-boxes of N
+    size_t box_count { 0 };
+
+    //! Number of final pieces of the left and right edges of N
+    size_t edge_piece_count { 0 };
+
+    //! Number of final parts which do not satisfy the covering conditions at maximal depth
+    size_t unresolved_count { 0 };
+
+    //! Number of final sub-boxes of N at given depth
+    std::vector<size_t> depth_histogram {};
+
+    void print(std::ostream& out) const
+    {
+        out << "refinement box_count " << box_count
+            << " edge_piece_count " << edge_piece_count
+            << " unresolved_count " << unresolved_count << '\n';
+
+        out << "refinement depth_histogram";
+        for (size_t depth = 0; depth < depth_histogram.size(); ++depth)
+        {
+            out << ' ' << depth << ':' << depth_histogram.at(depth);
+        }
+        out << '\n';
+    }
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //! @brief Compute image of set N under specified map and check covering relation conditions
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -25,7 +138,7 @@ public:
     using MatrixType = typename MapT::MatrixType;
 
     template<typename MapU>
-    CoveringRelationCheck(MapU& map)
+    CoveringRelationCheck(MapU& map, std::ostream& log = std::cout)
     {
         assert_with_exception(map.dimension() == 2);
         assert_with_exception(map.imageDimension() == 2);
@@ -43,13 +156,255 @@ public:
         const VectorType right = VectorType{ N[0].right(), N[1] };
         m_img_right = c1_map(right);
 
+        if constexpr (HasReturnTime<MapU>::value)
+        {
+            m_return_time = map.get_last_evaluation_return_time();
+        }
+
+        print_var_to( log, m_der );
+        print_var_to( log, CapdUtils::span_matrix( m_der ) );
+
+        print_var_to( log, m_img );
+        print_var_to( log, m_img_left );
+        print_var_to( log, m_img_right );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Subdivision mode
+    //! @details Set N is split into k x k grid of sub-boxes and its left and right edges are split into k pieces each. Every
+    //!          part is evaluated separately (possibly on several threads) and the results are joined with interval hull.
+    //!          Since the covering conditions are inclusions of the images, checking them on the hull is equivalent to
+    //!          checking them on every part.
+    //!
+    //! @param map_factory callable returning (smart) pointer to the map, called once per worker thread
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename MapFactoryT>
+    CoveringRelationCheck(MapFactoryT map_factory, const CoveringRelationSubdivision& subdivision, std::ostream& log = std::cout)
+    {
+        const size_t k = subdivision.grid_size;
+        assert_with_exception(k > 0);
+
+        const std::vector<ScalarType> parts = split(I, k);
+
+        const size_t box_count = k * k;
+        const size_t task_count = box_count + 2 * k;
+
+        std::vector<VectorType> imgs(task_count, VectorType(2));
+        std::vector<MatrixType> ders(box_count, MatrixType(2,2));
+        std::vector<ScalarType> return_times(task_count);
+
+        using MapPtr = decltype(map_factory());
+        using MapU = std::remove_reference_t<decltype(*std::declval<MapPtr&>())>;
+
+        ParallelExecutor executor { subdivision.worker_count };
+        executor.run(task_count, map_factory, [&](MapPtr& map_ptr, size_t idx)
+        {
+            MapU& map = *map_ptr;
+
+            assert_with_exception(map.dimension() == 2);
+            assert_with_exception(map.imageDimension() == 2);
+
+            CapdUtils::C1_Map<MapT, MapU&> c1_map
+            {
+                std::ref(map)
+            };
+
+            if (idx < box_count)
+            {
+                const VectorType box = VectorType{ parts.at(idx / k), parts.at(idx % k) };
+                imgs.at(idx) = c1_map(box, ders.at(idx));
+            }
+            else if (idx < box_count + k)
+            {
+                const VectorType left = VectorType{ N[0].left(), parts.at(idx - box_count) };
+                imgs.at(idx) = c1_map(left);
+            }
+            else
+            {
+                const VectorType right = VectorType{ N[0].right(), parts.at(idx - box_count - k) };
+                imgs.at(idx) = c1_map(right);
+            }
+
+            if constexpr (HasReturnTime<MapU>::value)
+            {
+                return_times.at(idx) = map.get_last_evaluation_return_time();
+            }
+        });
+
+        m_img = imgs.at(0);
+        m_der = ders.at(0);
+        for (size_t idx = 1; idx < box_count; ++idx)
+        {
+            m_img = capd::vectalg::intervalHull(m_img, imgs.at(idx));
+            m_der = capd::vectalg::intervalHull(m_der, ders.at(idx));
+        }
+
+        m_img_left = imgs.at(box_count);
+        m_img_right = imgs.at(box_count + k);
+        for (size_t j = 1; j < k; ++j)
+        {
+            m_img_left = capd::vectalg::intervalHull(m_img_left, imgs.at(box_count + j));
+            m_img_right = capd::vectalg::intervalHull(m_img_right, imgs.at(box_count + k + j));
+        }
+
+        // Keep the meaning of the single box mode, where the right edge is evaluated last
+        if constexpr (HasReturnTime<MapU>::value)
+        {
+            m_return_time = return_times.at(box_count + k);
+            for (size_t j = 1; j < k; ++j)
+            {
+                m_return_time = intervalHull(m_return_time, return_times.at(box_count + k + j));
+            }
+        }
+
+        print_var_to( log, k );
+
+        print_var_to( log, m_der );
+        print_var_to( log, CapdUtils::span_matrix( m_der ) );
 
-        print_var( m_der );
-        print_var( CapdUtils::span_matrix( m_der ) );
+        print_var_to( log, m_img );
+        print_var_to( log, m_img_left );
+        print_var_to( log, m_img_right );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Adaptive refinement mode
+    //! @details Starting from N and its left and right edges, only the parts whose image breaks the covering conditions
+    //!          (or whose evaluation fails) or which are wider than the width budget are bisected, up to the maximal depth.
+    //!          Sub-boxes of N are checked against the contraction condition, pieces of the edges against the expansion
+    //!          condition. The parts are processed by WorkStealingScheduler, so that deep refinement in one corner of N
+    //!          is shared among all workers. The final parts are joined with interval hull, as in subdivision mode.
+    //!
+    //! @param map_factory callable returning (smart) pointer to the map, called once per worker thread
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename MapFactoryT>
+    CoveringRelationCheck(MapFactoryT map_factory, const CoveringRelationRefinement& refinement, std::ostream& log = std::cout)
+    {
+        using MapPtr = decltype(map_factory());
+        using MapU = std::remove_reference_t<decltype(*std::declval<MapPtr&>())>;
+
+        const std::vector<RefinementPart> initial_parts
+        {
+            RefinementPart{ RefinementPart::Kind::Box, N, 0 },
+            RefinementPart{ RefinementPart::Kind::LeftEdge, VectorType{ N[0].left(), N[1] }, 0 },
+            RefinementPart{ RefinementPart::Kind::RightEdge, VectorType{ N[0].right(), N[1] }, 0 }
+        };
+
+        WorkStealingScheduler<RefinementPart> scheduler { refinement.worker_count };
+
+        // every worker collects its own final parts, so that no synchronization is needed
+        std::vector<std::vector<RefinementResult>> results(std::max(refinement.worker_count, 1u));
+
+        scheduler.run(initial_parts, map_factory, [&](MapPtr& map_ptr, size_t worker_idx, RefinementPart part, auto push)
+        {
+            MapU& map = *map_ptr;
 
-        print_var( m_img );
-        print_var( m_img_left );
-        print_var( m_img_right );
+            CapdUtils::C1_Map<MapT, MapU&> c1_map
+            {
+                std::ref(map)
+            };
+
+            RefinementResult result {};
+            result.part = part;
+
+            bool evaluated = true;
+            try
+            {
+                if (part.kind == RefinementPart::Kind::Box)
+                {
+                    result.img = c1_map(part.arg, result.der);
+                }
+                else
+                {
+                    result.img = c1_map(part.arg);
+                }
+
+                if constexpr (HasReturnTime<MapU>::value)
+                {
+                    result.return_time = map.get_last_evaluation_return_time();
+                }
+            }
+            catch (const std::exception&)
+            {
+                // too wide sets may fail to be evaluated (e.g. do not reach the section), they are refined as well
+                if (part.depth >= refinement.max_depth)
+                {
+                    throw;
+                }
+                evaluated = false;
+            }
+
+            const bool condition = evaluated && is_part_condition_satisfied(part.kind, result.img);
+
+            if (part.depth >= refinement.max_depth || (condition && get_width(part.arg) <= refinement.width_budget))
+            {
+                result.condition = condition;
+                results.at(worker_idx).push_back(std::move(result));
+                return;
+            }
+
+            for (RefinementPart& child : bisect(part))
+            {
+                push(std::move(child));
+            }
+        });
+
+        bool first_box = true;
+        bool first_left = true;
+        bool first_right = true;
+
+        for (const std::vector<RefinementResult>& worker_results : results)
+        {
+            for (const RefinementResult& result : worker_results)
+            {
+                const RefinementPart& part = result.part;
+
+                if (!result.condition)
+                {
+                    ++m_refinement_report.unresolved_count;
+                }
+
+                switch (part.kind)
+                {
+                    case RefinementPart::Kind::Box:
+                        m_img = first_box ? result.img : capd::vectalg::intervalHull(m_img, result.img);
+                        m_der = first_box ? result.der : capd::vectalg::intervalHull(m_der, result.der);
+                        first_box = false;
+
+                        ++m_refinement_report.box_count;
+                        if (m_refinement_report.depth_histogram.size() <= part.depth)
+                        {
+                            m_refinement_report.depth_histogram.resize(part.depth + 1, 0);
+                        }
+                        ++m_refinement_report.depth_histogram.at(part.depth);
+                        break;
+
+                    case RefinementPart::Kind::LeftEdge:
+                        m_img_left = first_left ? result.img : capd::vectalg::intervalHull(m_img_left, result.img);
+                        first_left = false;
+
+                        ++m_refinement_report.edge_piece_count;
+                        break;
+
+                    case RefinementPart::Kind::RightEdge:
+                        m_img_right = first_right ? result.img : capd::vectalg::intervalHull(m_img_right, result.img);
+                        m_return_time = first_right ? result.return_time : intervalHull(m_return_time, result.return_time);
+                        first_right = false;
+
+                        ++m_refinement_report.edge_piece_count;
+                        break;
+                }
+            }
+        }
+
+        m_refinement_report.print(log);
+
+        print_var_to( log, m_der );
+        print_var_to( log, CapdUtils::span_matrix( m_der ) );
+
+        print_var_to( log, m_img );
+        print_var_to( log, m_img_left );
+        print_var_to( log, m_img_right );
     }
 
     bool contraction_condition() const noexcept
@@ -72,11 +427,123 @@ public:
         return m_img;
     }
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Get return time of the evaluation of the right edge of N (only for maps that provide return time)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ScalarType get_return_time() const noexcept
+    {
+        return m_return_time;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Get statistics of the adaptive refinement (empty in the other modes)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    const CoveringRelationRefinementReport& get_refinement_report() const noexcept
+    {
+        return m_refinement_report;
+    }
+
 private:
+    template<typename MapU, typename = void>
+    struct HasReturnTime : std::false_type {};
+
+    template<typename MapU>
+    struct HasReturnTime<MapU, std::void_t<decltype(std::declval<const MapU&>().get_last_evaluation_return_time())>> : std::true_type {};
+
+    struct RefinementPart
+    {
+        enum class Kind
+        {
+            Box,
+            LeftEdge,
+            RightEdge
+        };
+
+        Kind kind { Kind::Box };
+        VectorType arg {};
+        unsigned depth { 0 };
+    };
+
+    struct RefinementResult
+    {
+        RefinementPart part {};
+        VectorType img { VectorType(2) };
+        MatrixType der { MatrixType(2,2) };
+        ScalarType return_time {};
+        bool condition { false };
+    };
+
+    static bool is_part_condition_satisfied(RefinementPart::Kind kind, const VectorType& img) noexcept
+    {
+        switch (kind)
+        {
+            case RefinementPart::Kind::Box: return img[1].subset( I );
+            case RefinementPart::Kind::LeftEdge: return img[0].rightBound() < I.leftBound();
+            case RefinementPart::Kind::RightEdge: return img[0].leftBound() > I.rightBound();
+            default: return false;
+        }
+    }
+
+    static double get_width(const VectorType& arg) noexcept
+    {
+        double ret = 0.0;
+        for (size_t i = 0; i < arg.dimension(); ++i)
+        {
+            ret = std::max(ret, arg[i].rightBound() - arg[i].leftBound());
+        }
+        return ret;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Split sub-box of N into 4 parts, or piece of an edge of N into 2 parts (the edge coordinate is not split)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static std::vector<RefinementPart> bisect(const RefinementPart& part)
+    {
+        const std::vector<ScalarType> halves_1 = split(part.arg[1], 2);
+        const std::vector<ScalarType> halves_0 = (part.kind == RefinementPart::Kind::Box)
+            ? split(part.arg[0], 2)
+            : std::vector<ScalarType>{ part.arg[0] };
+
+        std::vector<RefinementPart> ret {};
+        for (const ScalarType& x : halves_0)
+        {
+            for (const ScalarType& y : halves_1)
+            {
+                ret.push_back(RefinementPart{ part.kind, VectorType{ x, y }, part.depth + 1 });
+            }
+        }
+
+        return ret;
+    }
+
+    static std::vector<ScalarType> split(const ScalarType& arg, size_t k)
+    {
+        std::vector<ScalarType> ret {};
+        ret.reserve(k);
+
+        const double left = arg.leftBound();
+        const double right = arg.rightBound();
+
+        // The same double is used as the right end of one part and the left end of the next one, so the parts cover arg
+        double part_left = left;
+        for (size_t i = 1; i <= k; ++i)
+        {
+            const double part_right = (i == k) ? right : left + (right - left) * static_cast<double>(i) / static_cast<double>(k);
+            ret.emplace_back(part_left, part_right);
+            part_left = part_right;
+        }
+
+        return ret;
+    }
+
     VectorType m_img { VectorType(2) };
     MatrixType m_der { MatrixType(2,2) };
     VectorType m_img_left { VectorType(2) };
     VectorType m_img_right { VectorType(2) };
+
+    ScalarType m_return_time {};
+
+    CoveringRelationRefinementReport m_refinement_report {};
 };
 
 }
@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "tools/test_tools.hpp"
+
+#include <iostream>
+#include <string>
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Outcome of a single covering relation check
+//! @details Covering relations may be checked on worker threads. In that case the log of the check is buffered in the
+//!          verdict, and the verdict is reported later from the main thread, so that the output and the order of the
+//!          reported failures do not depend on the thread scheduling.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct CoveringRelationVerdict
+{
+    std::string description {};
+
+    bool contraction_condition { false };
+    bool expansion_condition { false };
+    bool collision_avoidance_condition { true };
+
+    std::string log {};
+
+    bool is_successful() const noexcept
+    {
+        return contraction_condition && expansion_condition && collision_avoidance_condition;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Print buffered log and report conditions as gtest expectations
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void report() const
+    {
+        std::cout << log;
+
+        EXPECT_TRUE(contraction_condition) << description;
+        EXPECT_TRUE(expansion_condition) << description;
+        EXPECT_TRUE(collision_avoidance_condition) << description;
+    }
+};
+
+}
@@ -8,69 +8,237 @@
 #include "homoclinic_orbit_origins_initial.hpp"
 #include "homoclinic_orbit_origins_generator.hpp"
 #include "homoclinic_orbit_coordsys_generator.hpp"
+#include "covering_relations_setup_cache.hpp"
 
 #include "tools/coordsys_utilities.hpp"
 
+#include <future>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
 namespace Pcr3bpProof
 {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //! @brief Generate and store local coordsys for periodic orbit and homoclinic orbit for later use in covering relations
+//! @details The setup consists of three stages:
+//!          - approximate periodic orbit coordsys,
+//!          - approximate homoclinic orbit origins (independent of the periodic orbit coordsys),
+//!          - homoclinic orbit coordsys (requires both previous stages).
+//!
+//!          In sequential mode all stages are computed in the constructor. In pipelined mode every stage is computed when
+//!          its result is requested for the first time, in the requesting thread (other threads requesting the same stage
+//!          wait for it). Hence independent stages requested from different threads run concurrently, and the covering
+//!          relations along the periodic orbit may be verified while the homoclinic orbit coordsys are still generated.
+//!
+//!          Homoclinic orbit coordsys are all available at once, since the stable directions are propagated backwards from
+//!          the last coordsys of the chain. The time steps between them are recorded in the same stage.
+//!
+//!          If a cache path is given (by default from PCR3BP_SETUP_CACHE), the generated stages are loaded from the cache
+//!          file when its key matches the current inputs (see CoveringRelationsSetupCache). Otherwise the stages are
+//!          generated and the cache file is rewritten once the homoclinic orbit coordsys are available.
+//!
+//!          The generators compute with the maps of the given pools, i.e. with the (double precision) mass parameter and
+//!          energy of the proof context (see ProofContext).
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class CoveringRelationsSetup
 {
 public:
-    std::vector<CapdUtils::LocalCoordinateSystem<IMap>> get_periodic_orbit_coordsys() const
+    using Coordsys = CapdUtils::LocalCoordinateSystem<IMap>;
+
+    enum class Mode
     {
-        RegLyapunovCollisionOrbitParameters<IMap> m_parameters {};
+        Sequential,
+        Pipelined
+    };
 
-        std::vector<CapdUtils::LocalCoordinateSystem<IMap>> periodic_orbit_coordsys(4);
+    explicit CoveringRelationsSetup(
+        std::shared_ptr<Pcr3bp::RegMapPools<RMap>> pools,
+        Mode mode = Mode::Sequential,
+        const std::string& cache_path = CoveringRelationsSetupCache::get_path_from_environment())
+    {
+        const uint64_t cache_key = CoveringRelationsSetupCache::compute_key(Pcr3bp::RegBasicObjects<RMap>{ pools });
 
-        periodic_orbit_coordsys.at(0) = CapdUtils::LocalCoordinateSystem<IMap>(
-            m_parameters.get_initial_point(),
-            CapdUtils::matrix_cast<IMatrix>(m_periodic_orbit_coordsys_approx.at(0).get_directions_matrix()) );
-        
-        periodic_orbit_coordsys.at(1) = CapdUtils::LocalCoordinateSystem<IMap>(
-            m_parameters.get_intermediate_point(),
-            CapdUtils::matrix_cast<IMatrix>(m_periodic_orbit_coordsys_approx.at(1).get_directions_matrix()) );
-        
-        periodic_orbit_coordsys.at(2) = CapdUtils::LocalCoordinateSystem<IMap>(
-            m_parameters.get_image_point(),
-            CapdUtils::matrix_cast<IMatrix>(m_periodic_orbit_coordsys_approx.at(2).get_directions_matrix()) );
-        
-        periodic_orbit_coordsys.at(3) = CapdUtils::LocalCoordinateSystem<IMap>(
-            m_parameters.get_intermediate_point_neg(),
-            CapdUtils::matrix_cast<IMatrix>(m_periodic_orbit_coordsys_approx.at(3).get_directions_matrix()) );
+        if (!cache_path.empty() && load_cache(cache_path, cache_key))
+        {
+            return;
+        }
 
-        return periodic_orbit_coordsys;
+        m_periodic_orbit_coordsys_approx = std::async(std::launch::deferred, [pools]()
+        {
+            return PeriodicOrbitCoordsysGenerator<RMap>{ pools }.get_coordsys_container();
+        }).share();
+
+        m_homoclinic_orbit_origins = std::async(std::launch::deferred, [pools]()
+        {
+            HomoclinicOrbitOriginsInitial<RMap> homoclinic_orbit_origins_initial {};
+            HomoclinicOrbitOriginsGenerator<RMap> homoclinic_orbit_origins_generator { homoclinic_orbit_origins_initial, pools };
+
+            return HomoclinicOrbitOrigins
+            {
+                homoclinic_orbit_origins_generator.get_points(),
+                homoclinic_orbit_origins_generator.get_total_expansion_factor()
+            };
+        }).share();
+
+        m_periodic_orbit_coordsys = std::async(std::launch::deferred, [periodic_approx = m_periodic_orbit_coordsys_approx]()
+        {
+            return convert_periodic_orbit_coordsys(periodic_approx.get());
+        }).share();
+
+        m_homoclinic_orbit = std::async(std::launch::deferred,
+            [periodic_approx = m_periodic_orbit_coordsys_approx, origins = m_homoclinic_orbit_origins, pools, cache_path, cache_key]()
+        {
+            const std::vector<CapdUtils::LocalCoordinateSystem<RMap>>& periodic_orbit_coordsys_approx = periodic_approx.get();
+            const HomoclinicOrbitOrigins& homoclinic_orbit_origins = origins.get();
+
+            HomoclinicOrbitCoordsysGenerator<RMap> homoclinic_orbit_coordsys_generator
+            {
+                periodic_orbit_coordsys_approx,
+                homoclinic_orbit_origins.points,
+                homoclinic_orbit_origins.total_expansion_factor,
+                pools
+            };
+
+            HomoclinicOrbit homoclinic_orbit
+            {
+                CapdUtils::CoordsysVec<IMap>::convert( homoclinic_orbit_coordsys_generator.get_coordsys_container() ),
+                homoclinic_orbit_coordsys_generator.get_step_schedules()
+            };
+
+            if (!cache_path.empty())
+            {
+                const CoveringRelationsSetupCache::Contents contents
+                {
+                    periodic_orbit_coordsys_approx,
+                    homoclinic_orbit_origins.points,
+                    homoclinic_orbit_origins.total_expansion_factor,
+                    homoclinic_orbit.coordsys,
+                    homoclinic_orbit.step_schedules
+                };
+
+                if (!CoveringRelationsSetupCache::write(cache_path, cache_key, contents))
+                {
+                    std::cerr << "Unable to write covering relations setup cache " << cache_path << std::endl;
+                }
+            }
+
+            return homoclinic_orbit;
+        }).share();
+
+        if (mode == Mode::Sequential)
+        {
+            m_homoclinic_orbit.wait();
+            m_periodic_orbit_coordsys.wait();
+        }
     }
 
-    std::vector<CapdUtils::LocalCoordinateSystem<IMap>> get_homoclinic_orbit_coordsys() const
+    const std::vector<Coordsys>& get_periodic_orbit_coordsys() const
     {
-        return CapdUtils::CoordsysVec<IMap>::convert( m_homoclinic_orbit_coordsys_generator.get_coordsys_container() );
+        return m_periodic_orbit_coordsys.get();
     }
 
-private:
-    PeriodicOrbitCoordsysGenerator<RMap> m_periodic_orbit_coordsys_generator_approx {};
+    const std::vector<Coordsys>& get_homoclinic_orbit_coordsys() const
+    {
+        return m_homoclinic_orbit.get().coordsys;
+    }
 
-    std::vector<CapdUtils::LocalCoordinateSystem<RMap>> m_periodic_orbit_coordsys_approx
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Time steps recorded along the homoclinic orbit (see HomoclinicOrbitCoordsysGenerator::get_step_schedules)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    const std::vector<CapdUtils::StepSchedule>& get_homoclinic_step_schedules() const
     {
-        m_periodic_orbit_coordsys_generator_approx.get_coordsys_container()
-    };
+        return m_homoclinic_orbit.get().step_schedules;
+    }
 
-    HomoclinicOrbitOriginsInitial<RMap> m_homoclinic_orbit_origins_initial {};
+    const std::vector<RVector>& get_homoclinic_orbit_origins() const
+    {
+        return m_homoclinic_orbit_origins.get().points;
+    }
 
-    HomoclinicOrbitOriginsGenerator<RMap> m_homoclinic_orbit_origins_generator
+private:
+    struct HomoclinicOrbitOrigins
     {
-        m_homoclinic_orbit_origins_initial
+        std::vector<RVector> points {};
+        Real total_expansion_factor {};
     };
 
-    HomoclinicOrbitCoordsysGenerator<RMap> m_homoclinic_orbit_coordsys_generator
+    struct HomoclinicOrbit
     {
-        m_periodic_orbit_coordsys_approx,
-        m_homoclinic_orbit_origins_generator.get_points(),
-        m_homoclinic_orbit_origins_generator.get_total_expansion_factor()
+        std::vector<Coordsys> coordsys {};
+        std::vector<CapdUtils::StepSchedule> step_schedules {};
     };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Set all stages from the cache file
+    //! @return False if the file is missing or its key does not match
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    bool load_cache(const std::string& cache_path, uint64_t cache_key)
+    {
+        std::optional<CoveringRelationsSetupCache::Contents> contents = CoveringRelationsSetupCache::read(cache_path, cache_key);
+
+        if (!contents)
+        {
+            return false;
+        }
+
+        m_periodic_orbit_coordsys_approx = make_ready(std::move(contents->periodic_orbit_coordsys_approx));
+        m_homoclinic_orbit_origins = make_ready(HomoclinicOrbitOrigins
+        {
+            std::move(contents->homoclinic_orbit_origins),
+            contents->total_expansion_factor
+        });
+        m_periodic_orbit_coordsys = make_ready(convert_periodic_orbit_coordsys(m_periodic_orbit_coordsys_approx.get()));
+        m_homoclinic_orbit = make_ready(HomoclinicOrbit
+        {
+            std::move(contents->homoclinic_orbit_coordsys),
+            std::move(contents->homoclinic_step_schedules)
+        });
+
+        return true;
+    }
+
+    template<typename T>
+    static std::shared_future<T> make_ready(T value)
+    {
+        std::promise<T> promise {};
+        promise.set_value(std::move(value));
+        return promise.get_future().share();
+    }
+
+    static std::vector<Coordsys> convert_periodic_orbit_coordsys(
+        const std::vector<CapdUtils::LocalCoordinateSystem<RMap>>& periodic_orbit_coordsys_approx)
+    {
+        RegLyapunovCollisionOrbitParameters<IMap> m_parameters {};
+
+        std::vector<Coordsys> periodic_orbit_coordsys(4);
+
+        periodic_orbit_coordsys.at(0) = Coordsys(
+            m_parameters.get_initial_point(),
+            CapdUtils::matrix_cast<IMatrix>(periodic_orbit_coordsys_approx.at(0).get_directions_matrix()) );
+        
+        periodic_orbit_coordsys.at(1) = Coordsys(
+            m_parameters.get_intermediate_point(),
+            CapdUtils::matrix_cast<IMatrix>(periodic_orbit_coordsys_approx.at(1).get_directions_matrix()) );
+        
+        periodic_orbit_coordsys.at(2) = Coordsys(
+            m_parameters.get_image_point(),
+            CapdUtils::matrix_cast<IMatrix>(periodic_orbit_coordsys_approx.at(2).get_directions_matrix()) );
+        
+        periodic_orbit_coordsys.at(3) = Coordsys(
+            m_parameters.get_intermediate_point_neg(),
+            CapdUtils::matrix_cast<IMatrix>(periodic_orbit_coordsys_approx.at(3).get_directions_matrix()) );
+
+        return periodic_orbit_coordsys;
+    }
+
+    std::shared_future<std::vector<CapdUtils::LocalCoordinateSystem<RMap>>> m_periodic_orbit_coordsys_approx {};
+    std::shared_future<HomoclinicOrbitOrigins> m_homoclinic_orbit_origins {};
+
+    std::shared_future<std::vector<Coordsys>> m_periodic_orbit_coordsys {};
+    std::shared_future<HomoclinicOrbit> m_homoclinic_orbit {};
 };
 
 }
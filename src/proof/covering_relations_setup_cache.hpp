@@ -0,0 +1,496 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <capd_utils/local_coordinate_system.hpp>
+
+#include "tools/types.hpp"
+#include "tools/step_replay_poincare_map.hpp"
+
+#include "periodic_orbit_parameters.hpp"
+#include "homoclinic_orbit_origins_initial.hpp"
+#include "pcr3bp_reg_basic_objects.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Hash of the sources of the setup generators, computed by CMake at configure time
+#ifndef PCR3BP_SETUP_SOURCE_HASH
+#define PCR3BP_SETUP_SOURCE_HASH ""
+#endif
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Results of the CoveringRelationsSetup generators stored in a binary file
+//! @details The file holds the bit patterns of the doubles of the approximate periodic orbit coordsys and of the homoclinic
+//!          orbit origins, the endpoints of the intervals of the homoclinic orbit coordsys and the time steps recorded along
+//!          the homoclinic orbit, so a loaded setup is identical to a generated one. The contents are valid only for the
+//!          inputs they were generated from, hence the file starts with a key hashed from:
+//!          - the format version and the layout of double,
+//!          - the hash of the generator sources, of all tools and of the capd_utils revision
+//!            (PCR3BP_SETUP_SOURCE_HASH),
+//!          - the constants of RegLyapunovCollisionOrbitParameters and HomoclinicOrbitOriginsInitial,
+//!          - the mass parameter, the energy and the Taylor order of the basic objects of the setup.
+//!
+//!          A file with a different key, a different size or a wrong checksum is ignored (the setup is regenerated).
+//!          Files are written to a temporary path and renamed, so concurrent processes never read a partial file.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class CoveringRelationsSetupCache
+{
+public:
+    struct Contents
+    {
+        std::vector<CapdUtils::LocalCoordinateSystem<RMap>> periodic_orbit_coordsys_approx {};
+        std::vector<RVector> homoclinic_orbit_origins {};
+        Real total_expansion_factor {};
+        std::vector<CapdUtils::LocalCoordinateSystem<IMap>> homoclinic_orbit_coordsys {};
+        std::vector<CapdUtils::StepSchedule> homoclinic_step_schedules {};
+    };
+
+    static constexpr uint32_t format_version = 2;
+
+    //! Key of the setup generated with the default basic objects
+    static uint64_t compute_key()
+    {
+        return compute_key(Pcr3bp::RegBasicObjects<RMap>{});
+    }
+
+    static uint64_t compute_key(const Pcr3bp::RegBasicObjects<RMap>& basic_objects)
+    {
+        Hash hash {};
+
+        hash.add(format_version);
+        hash.add(static_cast<uint32_t>(sizeof(double)));
+        hash.add(1.0);
+        hash.add(std::string(PCR3BP_SETUP_SOURCE_HASH));
+
+        hash.add(basic_objects.m_setup.get_mu(1));
+        hash.add(basic_objects.m_setup.get_mu(2));
+        hash.add(basic_objects.m_h0);
+        hash.add(basic_objects.m_order);
+
+        const RegLyapunovCollisionOrbitParameters<RMap>& parameters = basic_objects.m_parameters;
+        hash.add(parameters.get_energy());
+        hash.add(parameters.get_initial_point());
+        hash.add(parameters.get_intermediate_point());
+        hash.add(parameters.get_image_point());
+
+        const HomoclinicOrbitOriginsInitial<RMap> origins_initial {};
+        hash.add(static_cast<uint64_t>(origins_initial.get_points().size()));
+        for (const RVector& point : origins_initial.get_points())
+        {
+            hash.add(point);
+        }
+        hash.add(origins_initial.get_total_expansion_factor());
+
+        return hash.get();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Read contents stored with given key
+    //! @return Empty if the file does not exist, was stored with another key or is damaged
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static std::optional<Contents> read(const std::string& path, uint64_t key)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return std::nullopt;
+        }
+
+        const std::vector<char> data { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        if (data.size() < header_size + sizeof(uint64_t))
+        {
+            return std::nullopt;
+        }
+
+        Reader reader { data.data(), data.size() - sizeof(uint64_t) };
+
+        char magic[sizeof(s_magic)] {};
+        reader.read_bytes(magic, sizeof(magic));
+        if (std::memcmp(magic, s_magic, sizeof(s_magic)) != 0 || reader.read<uint64_t>() != key)
+        {
+            return std::nullopt;
+        }
+
+        uint64_t checksum {};
+        std::memcpy(&checksum, data.data() + data.size() - sizeof(uint64_t), sizeof(uint64_t));
+
+        Hash hash {};
+        hash.add_bytes(data.data(), data.size() - sizeof(uint64_t));
+        if (hash.get() != checksum)
+        {
+            return std::nullopt;
+        }
+
+        Contents ret {};
+
+        const uint64_t periodic_count = reader.read<uint64_t>();
+        for (uint64_t i = 0; i < periodic_count && reader.is_valid(); ++i)
+        {
+            ret.periodic_orbit_coordsys_approx.push_back(reader.read_coordsys<RMap>());
+        }
+
+        const uint64_t origins_count = reader.read<uint64_t>();
+        for (uint64_t i = 0; i < origins_count && reader.is_valid(); ++i)
+        {
+            ret.homoclinic_orbit_origins.push_back(reader.read_vector<RVector>());
+        }
+        ret.total_expansion_factor = reader.read<double>();
+
+        const uint64_t homoclinic_count = reader.read<uint64_t>();
+        for (uint64_t i = 0; i < homoclinic_count && reader.is_valid(); ++i)
+        {
+            ret.homoclinic_orbit_coordsys.push_back(reader.read_coordsys<IMap>());
+        }
+
+        const uint64_t schedule_count = reader.read<uint64_t>();
+        for (uint64_t i = 0; i < schedule_count && reader.is_valid(); ++i)
+        {
+            ret.homoclinic_step_schedules.push_back(reader.read_step_schedule());
+        }
+
+        if (!reader.is_valid() || !reader.is_at_end())
+        {
+            return std::nullopt;
+        }
+
+        return ret;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Store contents with given key, replaces the file atomically
+    //! @return False if the file could not be written
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static bool write(const std::string& path, uint64_t key, const Contents& contents)
+    {
+        Writer writer {};
+
+        writer.write_bytes(s_magic, sizeof(s_magic));
+        writer.write(key);
+
+        writer.write(static_cast<uint64_t>(contents.periodic_orbit_coordsys_approx.size()));
+        for (const auto& coordsys : contents.periodic_orbit_coordsys_approx)
+        {
+            writer.write_coordsys(coordsys);
+        }
+
+        writer.write(static_cast<uint64_t>(contents.homoclinic_orbit_origins.size()));
+        for (const RVector& point : contents.homoclinic_orbit_origins)
+        {
+            writer.write_vector(point);
+        }
+        writer.write(static_cast<double>(contents.total_expansion_factor));
+
+        writer.write(static_cast<uint64_t>(contents.homoclinic_orbit_coordsys.size()));
+        for (const auto& coordsys : contents.homoclinic_orbit_coordsys)
+        {
+            writer.write_coordsys(coordsys);
+        }
+
+        writer.write(static_cast<uint64_t>(contents.homoclinic_step_schedules.size()));
+        for (const CapdUtils::StepSchedule& schedule : contents.homoclinic_step_schedules)
+        {
+            writer.write_step_schedule(schedule);
+        }
+
+        Hash hash {};
+        hash.add_bytes(writer.m_data.data(), writer.m_data.size());
+        writer.write(hash.get());
+
+        // the temporary file name is random, so that concurrent writers do not interleave
+        const std::string tmp_path = path + ".tmp." + std::to_string(std::random_device{}());
+        {
+            std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+            file.write(writer.m_data.data(), static_cast<std::streamsize>(writer.m_data.size()));
+            if (!file)
+            {
+                std::remove(tmp_path.c_str());
+                return false;
+            }
+        }
+
+        if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+        {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Path of the cache file from PCR3BP_SETUP_CACHE environment variable (empty if not set)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static std::string get_path_from_environment()
+    {
+        const char* env = std::getenv("PCR3BP_SETUP_CACHE");
+        return env ? std::string(env) : std::string();
+    }
+
+private:
+    static constexpr char s_magic[8] { 'P', 'C', 'R', '3', 'S', 'E', 'T', 'C' };
+    static constexpr size_t header_size = sizeof(s_magic) + sizeof(uint64_t);
+
+    //! FNV-1a, 64 bit
+    class Hash
+    {
+    public:
+        void add_bytes(const void* data, size_t size)
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                m_value ^= bytes[i];
+                m_value *= 0x100000001b3ull;
+            }
+        }
+
+        void add(uint32_t value)
+        {
+            add_bytes(&value, sizeof(value));
+        }
+
+        void add(uint64_t value)
+        {
+            add_bytes(&value, sizeof(value));
+        }
+
+        void add(double value)
+        {
+            add_bytes(&value, sizeof(value));
+        }
+
+        void add(const std::string& value)
+        {
+            add(static_cast<uint64_t>(value.size()));
+            add_bytes(value.data(), value.size());
+        }
+
+        void add(const RVector& value)
+        {
+            add(static_cast<uint64_t>(value.dimension()));
+            for (size_t i = 0; i < value.dimension(); ++i)
+            {
+                add(static_cast<double>(value[i]));
+            }
+        }
+
+        uint64_t get() const noexcept
+        {
+            return m_value;
+        }
+
+    private:
+        uint64_t m_value { 0xcbf29ce484222325ull };
+    };
+
+    //! Scalars are stored as bit patterns of doubles, intervals by their endpoints
+    struct Writer
+    {
+        void write_bytes(const void* data, size_t size)
+        {
+            const char* bytes = static_cast<const char*>(data);
+            m_data.insert(m_data.end(), bytes, bytes + size);
+        }
+
+        template<typename T>
+        void write(T value)
+        {
+            write_bytes(&value, sizeof(value));
+        }
+
+        void write_scalar(double value)
+        {
+            write(value);
+        }
+
+        void write_scalar(const Interval& value)
+        {
+            write(value.leftBound());
+            write(value.rightBound());
+        }
+
+        template<typename VectorT>
+        void write_vector(const VectorT& value)
+        {
+            write(static_cast<uint64_t>(value.dimension()));
+            for (size_t i = 0; i < value.dimension(); ++i)
+            {
+                write_scalar(value[i]);
+            }
+        }
+
+        template<typename MapT>
+        void write_coordsys(const CapdUtils::LocalCoordinateSystem<MapT>& coordsys)
+        {
+            const typename MapT::MatrixType& directions = coordsys.get_directions_matrix();
+
+            write_vector(coordsys.get_origin());
+            write(static_cast<uint64_t>(directions.numberOfRows()));
+            write(static_cast<uint64_t>(directions.numberOfColumns()));
+            for (size_t i = 0; i < directions.numberOfRows(); ++i)
+            {
+                for (size_t j = 0; j < directions.numberOfColumns(); ++j)
+                {
+                    write_scalar(directions[i][j]);
+                }
+            }
+        }
+
+        void write_step_schedule(const CapdUtils::StepSchedule& schedule)
+        {
+            write(static_cast<uint64_t>(schedule.size()));
+            for (const double step : schedule)
+            {
+                write(step);
+            }
+        }
+
+        std::vector<char> m_data {};
+    };
+
+    //! Reads past the end of the data invalidate the reader instead of throwing
+    class Reader
+    {
+    public:
+        Reader(const char* data, size_t size) : m_data(data), m_size(size)
+        {}
+
+        void read_bytes(void* dst, size_t size)
+        {
+            if (!m_valid || size > m_size - m_pos)
+            {
+                m_valid = false;
+                std::memset(dst, 0, size);
+                return;
+            }
+
+            std::memcpy(dst, m_data + m_pos, size);
+            m_pos += size;
+        }
+
+        template<typename T>
+        T read()
+        {
+            T ret {};
+            read_bytes(&ret, sizeof(ret));
+            return ret;
+        }
+
+        template<typename ScalarT>
+        ScalarT read_scalar()
+        {
+            if constexpr (std::is_same_v<ScalarT, Interval>)
+            {
+                const double left = read<double>();
+                const double right = read<double>();
+                if (!(left <= right))
+                {
+                    m_valid = false;
+                    return Interval(0.0);
+                }
+                return Interval(left, right);
+            }
+            else
+            {
+                return ScalarT(read<double>());
+            }
+        }
+
+        template<typename VectorT>
+        VectorT read_vector()
+        {
+            const uint64_t dimension = read<uint64_t>();
+            if (!m_valid || dimension > max_dimension)
+            {
+                m_valid = false;
+                return VectorT(0);
+            }
+
+            VectorT ret(static_cast<int>(dimension));
+            for (size_t i = 0; i < dimension; ++i)
+            {
+                ret[i] = read_scalar<typename VectorT::ScalarType>();
+            }
+            return ret;
+        }
+
+        template<typename MapT>
+        CapdUtils::LocalCoordinateSystem<MapT> read_coordsys()
+        {
+            using ScalarType = typename MapT::ScalarType;
+            using VectorType = typename MapT::VectorType;
+            using MatrixType = typename MapT::MatrixType;
+
+            const VectorType origin = read_vector<VectorType>();
+            const uint64_t rows = read<uint64_t>();
+            const uint64_t columns = read<uint64_t>();
+            if (!m_valid || rows > max_dimension || columns > max_dimension)
+            {
+                m_valid = false;
+                return CapdUtils::LocalCoordinateSystem<MapT>(VectorType(0), MatrixType(0, 0));
+            }
+
+            MatrixType directions(static_cast<int>(rows), static_cast<int>(columns));
+            for (size_t i = 0; i < rows; ++i)
+            {
+                for (size_t j = 0; j < columns; ++j)
+                {
+                    directions[i][j] = read_scalar<ScalarType>();
+                }
+            }
+
+            return CapdUtils::LocalCoordinateSystem<MapT>(origin, directions);
+        }
+
+        CapdUtils::StepSchedule read_step_schedule()
+        {
+            const uint64_t size = read<uint64_t>();
+            if (!m_valid || size > (m_size - m_pos) / sizeof(double))
+            {
+                m_valid = false;
+                return CapdUtils::StepSchedule {};
+            }
+
+            CapdUtils::StepSchedule ret(size);
+            for (double& step : ret)
+            {
+                step = read<double>();
+            }
+            return ret;
+        }
+
+        bool is_valid() const noexcept
+        {
+            return m_valid;
+        }
+
+        bool is_at_end() const noexcept
+        {
+            return m_pos == m_size;
+        }
+
+    private:
+        static constexpr uint64_t max_dimension = 16;
+
+        const char* m_data;
+        size_t m_size;
+        size_t m_pos { 0 };
+        bool m_valid { true };
+    };
+};
+
+}
@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "tools/test_tools.hpp"
+
+#include "covering_relations_setup_cache.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Stored contents are read back bit-exactly, files with another key or damaged files are rejected
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_covering_relations_setup_cache, round_trip)
+{
+    using namespace Pcr3bpProof;
+
+    auto same_bits = [](double lhs, double rhs) { return std::memcmp(&lhs, &rhs, sizeof(double)) == 0; };
+
+    RMatrix directions(4, 4);
+    IMatrix interval_directions(4, 4);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        for (size_t j = 0; j < 4; ++j)
+        {
+            directions[i][j] = std::sin(1.0 + i + 4.0 * j);
+            interval_directions[i][j] = Interval(directions[i][j], std::nextafter(directions[i][j], 2.0));
+        }
+    }
+
+    CoveringRelationsSetupCache::Contents contents {};
+    contents.periodic_orbit_coordsys_approx.emplace_back(RVector{ 0.1, -0.0, 1.0 / 3.0, -2.0 }, directions);
+    contents.homoclinic_orbit_origins.push_back(RVector{ 1.0 / 7.0, 0.0, std::numeric_limits<double>::min(), 5.0 });
+    contents.total_expansion_factor = 1.0e10 / 3.0;
+    contents.homoclinic_orbit_coordsys.emplace_back(
+        IVector{ Interval(0.1, 0.2), Interval(-1.0 / 3.0), Interval(0.0), Interval(2.0, 3.0) }, interval_directions);
+    contents.homoclinic_step_schedules.push_back(CapdUtils::StepSchedule{ 1.0 / 3.0, 0.0, std::numeric_limits<double>::min() });
+    contents.homoclinic_step_schedules.push_back(CapdUtils::StepSchedule{});
+
+    const std::string path = ::testing::TempDir() + "pcr3bp_setup_cache_test.bin";
+    const uint64_t key = CoveringRelationsSetupCache::compute_key();
+
+    ASSERT_TRUE(CoveringRelationsSetupCache::write(path, key, contents));
+
+    const auto loaded = CoveringRelationsSetupCache::read(path, key);
+    ASSERT_TRUE(loaded.has_value());
+
+    ASSERT_EQ(loaded->periodic_orbit_coordsys_approx.size(), 1u);
+    ASSERT_EQ(loaded->homoclinic_orbit_origins.size(), 1u);
+    ASSERT_EQ(loaded->homoclinic_orbit_coordsys.size(), 1u);
+    ASSERT_EQ(loaded->homoclinic_step_schedules.size(), 2u);
+    ASSERT_EQ(loaded->homoclinic_step_schedules.at(0).size(), 3u);
+    EXPECT_TRUE(loaded->homoclinic_step_schedules.at(1).empty());
+    EXPECT_TRUE(same_bits(loaded->total_expansion_factor, contents.total_expansion_factor));
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(same_bits(loaded->periodic_orbit_coordsys_approx.at(0).get_origin()[i],
+            contents.periodic_orbit_coordsys_approx.at(0).get_origin()[i]));
+        EXPECT_TRUE(same_bits(loaded->homoclinic_orbit_origins.at(0)[i], contents.homoclinic_orbit_origins.at(0)[i]));
+
+        const Interval& loaded_origin = loaded->homoclinic_orbit_coordsys.at(0).get_origin()[i];
+        const Interval& origin = contents.homoclinic_orbit_coordsys.at(0).get_origin()[i];
+        EXPECT_TRUE(same_bits(loaded_origin.leftBound(), origin.leftBound()));
+        EXPECT_TRUE(same_bits(loaded_origin.rightBound(), origin.rightBound()));
+
+        for (size_t j = 0; j < 4; ++j)
+        {
+            EXPECT_TRUE(same_bits(loaded->periodic_orbit_coordsys_approx.at(0).get_directions_matrix()[i][j], directions[i][j]));
+
+            const Interval& loaded_direction = loaded->homoclinic_orbit_coordsys.at(0).get_directions_matrix()[i][j];
+            EXPECT_TRUE(same_bits(loaded_direction.leftBound(), interval_directions[i][j].leftBound()));
+            EXPECT_TRUE(same_bits(loaded_direction.rightBound(), interval_directions[i][j].rightBound()));
+        }
+    }
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        EXPECT_TRUE(same_bits(loaded->homoclinic_step_schedules.at(0).at(i), contents.homoclinic_step_schedules.at(0).at(i)));
+    }
+
+    EXPECT_FALSE(CoveringRelationsSetupCache::read(path, key + 1).has_value());
+
+    // flip a bit of the payload
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(40);
+        const char byte = static_cast<char>(file.get() ^ 0x01);
+        file.seekp(40);
+        file.put(byte);
+    }
+    EXPECT_FALSE(CoveringRelationsSetupCache::read(path, key).has_value());
+
+    std::remove(path.c_str());
+    EXPECT_FALSE(CoveringRelationsSetupCache::read(path, key).has_value());
+}
@@ -11,6 +11,10 @@
 //!        In this computation we also perform a part of interval arithmetic validation of the proof of Lemma 8, where we
 //!        assert that the trajectories shadowing the covering relations described above, do not intersect with the collision
 //!        manifold.
+//!
+//!        The covering relations are independent of each other, so they are verified concurrently. The number of worker
+//!        threads may be set with PCR3BP_WORKER_COUNT environment variable. Taylor orders of the covering relations may be
+//!        calibrated or read from a file, see select_taylor_orders_from_environment.
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST(Pcr3bp_proof, homoclinic_coverings)
 {
@@ -18,9 +22,10 @@ TEST(Pcr3bp_proof, homoclinic_coverings)
 
     capd::rounding::DoubleRounding::roundNearest();
 
-    CoveringRelationsSetup setup {};
-    CoveringRelationsTest<IMap> test { setup };
-    test.check_homoclinic_coverings();
+    ProofContext<IMap> context {};
+    CoveringRelationsTest<IMap> test { context };
+    test.select_taylor_orders_from_environment( ParallelExecutor::get_default_worker_count() );
+    test.check_homoclinic_coverings( ParallelExecutor::get_default_worker_count() );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -37,8 +42,8 @@ TEST(Pcr3bp_proof, periodic_coverings)
 
     capd::rounding::DoubleRounding::roundNearest();
 
-    CoveringRelationsSetup setup {};
-    CoveringRelationsTest<IMap> test { setup };
+    ProofContext<IMap> context {};
+    CoveringRelationsTest<IMap> test { context };
     test.check_periodic_coverings();
 }
 
@@ -56,8 +61,8 @@ TEST(Pcr3bp_proof, jump_coverings)
 
     capd::rounding::DoubleRounding::roundNearest();
 
-    CoveringRelationsSetup setup {};
-    CoveringRelationsTest<IMap> test { setup };
+    ProofContext<IMap> context {};
+    CoveringRelationsTest<IMap> test { context };
     test.check_jump_coverings();
 }
 
@@ -75,7 +80,7 @@ TEST(Pcr3bp_proof, parallelogram_coverings_beginning)
 
     capd::rounding::DoubleRounding::roundNearest();
 
-    CoveringRelationsSetup setup {};
-    CoveringRelationsTest<IMap> test { setup };
+    ProofContext<IMap> context {};
+    CoveringRelationsTest<IMap> test { context };
     test.parallelogram_covering_beginning_check();
 }
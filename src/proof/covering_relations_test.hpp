@@ -6,14 +6,21 @@
 
 #include "tools/test_tools.hpp"
 
+#include "tools/parallel_executor.hpp"
 #include "tools/solution_curve_with_condition_check.hpp"
-#include "tools/auxiliary_functions.hpp"
+#include "tools/generated_maps.hpp"
 
 #include "covering_relations_test_base.hpp"
 #include "covering_relation_checker.hpp"
+#include "covering_relation_verdict.hpp"
 
 #include "scaled_local_poincare4_map.hpp"
 
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
 namespace Pcr3bpProof
 {
 
@@ -27,63 +34,230 @@ public:
 
     using Coordsys = CapdUtils::LocalCoordinateSystem<MapT>;
 
-    CoveringRelationsTest(const CoveringRelationsSetup& setup)
-        : CoveringRelationsTestBase<MapT>(setup)
+    CoveringRelationsTest(ProofContext<MapT>& context)
+        : CoveringRelationsTestBase<MapT>(context)
     {}
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //! @brief Check covering relations along homoclinic orbit
+    //!
+    //! @param worker_count number of threads on which the coordsys pairs are verified
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    void check_homoclinic_coverings()
+    void check_homoclinic_coverings(unsigned worker_count = 1)
     {
-        for (size_t i = 1; i < this->m_homoclinic_orbit_coordsys.size(); ++i)
-        {
-            const size_t src_idx = i-1;
-            const size_t dst_idx = i;
-            std::cout << "homoclinic orbit covering " << src_idx << " => " << dst_idx << '\n';
+        // threads left over by the distribution of pairs are used by the collision avoidance checks
+        const unsigned collision_check_worker_count = std::max(1u, this->m_collision_check_worker_count / std::max(1u, worker_count));
+
+        using BasicObjectsPtr = std::unique_ptr<Pcr3bp::RegBasicObjects<MapT>>;
 
-            const CapdUtils::LocalCoordinateSystem<MapT> coordsys_src = this->m_homoclinic_orbit_coordsys.at(src_idx);
-            const CapdUtils::LocalCoordinateSystem<MapT> coordsys_dst = this->m_homoclinic_orbit_coordsys.at(dst_idx);
+        const size_t pair_count = this->get_homoclinic_orbit_coordsys().size() - 1;
+        std::vector<CoveringRelationVerdict> verdicts(pair_count);
+
+        ParallelExecutor executor { worker_count };
+        executor.run(
+            pair_count,
+            [this]() -> BasicObjectsPtr
+            {
+                return this->m_context.create_basic_objects();
+            },
+            [this, &verdicts, collision_check_worker_count](BasicObjectsPtr& basic_objects, size_t i)
+            {
+                verdicts.at(i) = check_homoclinic_covering(*basic_objects, i, collision_check_worker_count);
+            });
 
-            const ScalarType time_span = check_covering_relation_forward(coordsys_src, coordsys_dst);
-            simple_collision_avoidance_check(coordsys_src, coordsys_dst, time_span);
+        for (const CoveringRelationVerdict& verdict : verdicts)
+        {
+            verdict.report();
         }
     }
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    //! @brief Check covering relations along periodic orbit
+    //! @brief Select Taylor order of every covering relation along homoclinic orbit (see select_taylor_order)
+    //! @details The pairs are calibrated concurrently, the candidate orders of a single pair are evaluated in the same thread
+    //!          one after another. The selected orders are used by the subsequent covering relation checks.
+    //!
+    //! @param worker_count number of threads on which the coordsys pairs are calibrated
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    void check_periodic_coverings()
+    const TaylorOrderTable& calibrate_homoclinic_taylor_orders(const TaylorOrderCalibration& calibration, unsigned worker_count = 1)
     {
+        const size_t pair_count = this->get_homoclinic_orbit_coordsys().size() - 1;
+        std::vector<TaylorOrderSelection> selections(pair_count);
+
+        ParallelExecutor executor { worker_count };
+        executor.run(
+            pair_count,
+            []() { return 0; },
+            [this, &calibration, &selections](int, size_t i)
+            {
+                const Coordsys& coordsys_src = this->get_homoclinic_orbit_coordsys().at(i);
+                const Coordsys& coordsys_dst = this->get_homoclinic_orbit_coordsys().at(i + 1);
+
+                auto map_factory = [&](unsigned order)
+                {
+                    return std::make_unique<ScaledLocalPoincare4_MapInstance<MapT>>(
+                        this->m_context.get_pools(),
+                        Direction::Positive,
+                        order,
+                        coordsys_src,
+                        coordsys_dst,
+                        this->m_gain_factor,
+                        false,
+                        false,
+                        nullptr,
+                        this->m_energy_surface_reduction,
+                        this->get_homoclinic_step_schedule(i));
+                };
+
+                selections.at(i) = select_taylor_order<MapT>(calibration, map_factory, N);
+                selections.at(i).description = "homoclinic orbit covering " + std::to_string(i) + " => " + std::to_string(i + 1);
+            });
+
+        for (size_t i = 0; i < pair_count; ++i)
         {
-            std::cout << "periodic orbit covering 0 => 1\n";
+            selections.at(i).print(std::cout);
+            this->m_taylor_orders.set_homoclinic_order(i, selections.at(i).order);
+        }
+
+        return this->m_taylor_orders;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Set Taylor orders of the homoclinic coverings as requested by the environment
+    //! @details If PCR3BP_TAYLOR_ORDER_TABLE names an existing file, the orders are read from it. Otherwise, if
+    //!          PCR3BP_TAYLOR_ORDERS is set, the orders are calibrated (and written to PCR3BP_TAYLOR_ORDER_TABLE if set).
+    //!          Without both variables the fixed order of the basic objects is used.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void select_taylor_orders_from_environment(unsigned worker_count = 1)
+    {
+        const std::string path = TaylorOrderTable::get_path_from_environment();
 
-            const CapdUtils::LocalCoordinateSystem<MapT> coordsys_src = this->m_periodic_orbit_coordsys.at(0);
-            const CapdUtils::LocalCoordinateSystem<MapT> coordsys_dst = this->m_periodic_orbit_coordsys.at(1);
-            check_covering_relation_forward(coordsys_src, coordsys_dst, true);
+        if (!path.empty() && std::ifstream(path).good())
+        {
+            this->m_taylor_orders = TaylorOrderTable::read(path);
+            return;
         }
 
+        TaylorOrderCalibration calibration {};
+        if (!TaylorOrderCalibration::from_environment(calibration))
         {
-            std::cout << "periodic orbit covering 1 => 2\n";
+            return;
+        }
+
+        calibrate_homoclinic_taylor_orders(calibration, worker_count);
 
-            const CapdUtils::LocalCoordinateSystem<MapT> coordsys_src = this->m_periodic_orbit_coordsys.at(1);
-            const CapdUtils::LocalCoordinateSystem<MapT> coordsys_dst = this->m_periodic_orbit_coordsys.at(2);
-            const ScalarType time_span = check_covering_relation_forward(coordsys_src, coordsys_dst);
-            simple_collision_avoidance_check(coordsys_src, coordsys_dst, time_span);
+        if (!path.empty())
+        {
+            this->m_taylor_orders.write(path);
         }
     }
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Check covering relation between homoclinic orbit coordsys with indices src_idx and src_idx+1
+    //! @details Only the provided basic objects are evaluated, so the function may be called concurrently for different
+    //!          pairs as long as every thread provides its own basic objects.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    CoveringRelationVerdict check_homoclinic_covering(
+        Pcr3bp::RegBasicObjects<MapT>& basic_objects,
+        size_t src_idx,
+        unsigned collision_check_worker_count = 1) const
+    {
+        const size_t dst_idx = src_idx + 1;
+        const unsigned order = this->m_taylor_orders.get_homoclinic_order(src_idx);
+
+        std::stringstream log {};
+        log.precision(std::cout.precision());
+
+        CoveringRelationVerdict verdict {};
+        verdict.description = "homoclinic orbit covering " + std::to_string(src_idx) + " => " + std::to_string(dst_idx);
+        log << verdict.description << '\n';
+        if (order != basic_objects.m_order)
+        {
+            log << "taylor order " << order << '\n';
+        }
+
+        const CapdUtils::LocalCoordinateSystem<MapT> coordsys_src = this->get_homoclinic_orbit_coordsys().at(src_idx);
+        const CapdUtils::LocalCoordinateSystem<MapT> coordsys_dst = this->get_homoclinic_orbit_coordsys().at(dst_idx);
+
+        const ScalarType time_span = check_covering_relation_forward(basic_objects, order, verdict, log, coordsys_src, coordsys_dst,
+            false, false, this->get_homoclinic_step_schedule(src_idx));
+        simple_collision_avoidance_check(basic_objects, order, verdict, log, coordsys_src, coordsys_dst, time_span, collision_check_worker_count);
+
+        verdict.log = log.str();
+        return verdict;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Check covering relations along periodic orbit
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void check_periodic_coverings()
+    {
+        check_periodic_covering(0).report();
+        check_periodic_covering(1).report();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Check covering relation between periodic orbit coordsys with indices src_idx and src_idx+1 (src_idx < 2)
+    //! @details The log is buffered in the verdict. Collision avoidance is not checked for the covering which starts in N_0
+    //!          (specialized psi0 coordinates).
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    CoveringRelationVerdict check_periodic_covering(size_t src_idx)
+    {
+        assert_with_exception(src_idx < 2);
+
+        const size_t dst_idx = src_idx + 1;
+
+        std::stringstream log {};
+        log.precision(std::cout.precision());
+
+        CoveringRelationVerdict verdict {};
+        verdict.description = "periodic orbit covering " + std::to_string(src_idx) + " => " + std::to_string(dst_idx);
+        log << verdict.description << '\n';
+
+        const CapdUtils::LocalCoordinateSystem<MapT> coordsys_src = this->get_periodic_orbit_coordsys().at(src_idx);
+        const CapdUtils::LocalCoordinateSystem<MapT> coordsys_dst = this->get_periodic_orbit_coordsys().at(dst_idx);
+
+        if (src_idx == 0)
+        {
+            check_covering_relation_forward(this->m_basic_objects, this->m_basic_objects.m_order, verdict, log, coordsys_src, coordsys_dst, true);
+        }
+        else
+        {
+            const ScalarType time_span = check_covering_relation_forward(this->m_basic_objects, this->m_basic_objects.m_order, verdict, log, coordsys_src, coordsys_dst);
+            simple_collision_avoidance_check(this->m_basic_objects, this->m_basic_objects.m_order, verdict, log, coordsys_src, coordsys_dst, time_span, this->m_collision_check_worker_count);
+        }
+
+        verdict.log = log.str();
+        return verdict;
+    }
+
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //! @brief Check covering relations between homoclinic and periodic orbits
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     void check_jump_coverings()
     {
-        std::cout << "periodic (3) => first homoclinic covering\n";
+        check_jump_covering().report();
+    }
 
-        const CapdUtils::LocalCoordinateSystem<MapT> coordsys_src = this->m_periodic_orbit_coordsys.at(3);
-        const CapdUtils::LocalCoordinateSystem<MapT> coordsys_dst = *( this->m_homoclinic_orbit_coordsys.begin() );
-        const ScalarType time_span = check_covering_relation_forward(coordsys_src, coordsys_dst);
-        simple_collision_avoidance_check(coordsys_src, coordsys_dst, time_span);
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Check covering relation between the last periodic orbit coordsys and the first homoclinic orbit coordsys
+    //! @details The log is buffered in the verdict.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    CoveringRelationVerdict check_jump_covering()
+    {
+        std::stringstream log {};
+        log.precision(std::cout.precision());
+
+        CoveringRelationVerdict verdict {};
+        verdict.description = "periodic (3) => first homoclinic covering";
+        log << verdict.description << '\n';
+
+        const CapdUtils::LocalCoordinateSystem<MapT> coordsys_src = this->get_periodic_orbit_coordsys().at(3);
+        const CapdUtils::LocalCoordinateSystem<MapT> coordsys_dst = *( this->get_homoclinic_orbit_coordsys().begin() );
+        const ScalarType time_span = check_covering_relation_forward(this->m_basic_objects, this->m_basic_objects.m_order, verdict, log, coordsys_src, coordsys_dst);
+        simple_collision_avoidance_check(this->m_basic_objects, this->m_basic_objects.m_order, verdict, log, coordsys_src, coordsys_dst, time_span, this->m_collision_check_worker_count);
+
+        verdict.log = log.str();
+        return verdict;
     }
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -91,6 +265,22 @@ public:
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     void parallelogram_covering_beginning_check()
     {
+        check_parallelogram_covering_beginning().report();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Check covering relation between the last periodic orbit coordsys and the first parallelogram
+    //! @details The log is buffered in the verdict. Collision avoidance is not checked.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    CoveringRelationVerdict check_parallelogram_covering_beginning()
+    {
+        std::stringstream log {};
+        log.precision(std::cout.precision());
+
+        CoveringRelationVerdict verdict {};
+        verdict.description = "parallelogram covering beginning";
+        log << verdict.description << '\n';
+
         const ScalarType L = this->m_basic_objects.m_parallelogram_coverings_parameters.L;
         const ScalarType b0 = this->m_basic_objects.m_parallelogram_coverings_parameters.b0;
         const ScalarType a0 = this->m_basic_objects.m_parallelogram_coverings_parameters.a0;
@@ -99,12 +289,12 @@ public:
         EXPECT_TRUE(a0 < b0);
         EXPECT_TRUE(b0 < 1);
 
-        MapT R_inverse = AuxiliaryFunctions<MapT>::R_Inverse(a0, b0);
-        MapT eta_inverse = AuxiliaryFunctions<MapT>::eta( -L );
-        MapT J = AuxiliaryFunctions<MapT>::J();
+        auto R_inverse = GeneratedMaps<MapT>::r_inverse(a0, b0);
+        auto eta_inverse = GeneratedMaps<MapT>::eta( -L );
+        auto J = GeneratedMaps<MapT>::j();
 
-        const CapdUtils::LocalCoordinateSystem<MapT> coordsys_src = this->m_periodic_orbit_coordsys.at(3);
-        const CapdUtils::LocalCoordinateSystem<MapT> coordsys_dst = *( this->m_homoclinic_orbit_coordsys.begin() );
+        const CapdUtils::LocalCoordinateSystem<MapT> coordsys_src = this->get_periodic_orbit_coordsys().at(3);
+        const CapdUtils::LocalCoordinateSystem<MapT> coordsys_dst = *( this->get_homoclinic_orbit_coordsys().begin() );
 
         ScaledLocalPoincare4_Map<MapT> poincare
         {
@@ -132,46 +322,101 @@ public:
             std::ref(R_inverse)
         };
         
-        CoveringRelationCheck cr { composite };
+        CoveringRelationCheck cr { composite, log };
 
-        EXPECT_TRUE(cr.contraction_condition());
-        EXPECT_TRUE(cr.expansion_condition());
+        verdict.contraction_condition = cr.contraction_condition();
+        verdict.expansion_condition = cr.expansion_condition();
+
+        verdict.log = log.str();
+        return verdict;
     }
 
 private:
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //! @brief Check forward covering relation between given local coordinate systems
+    //! @details If step_schedule is set, the Poincare maps replay its time steps (see StepReplayPoincareMap).
     //! @return Time interval of underlying evolved trajectory
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     ScalarType check_covering_relation_forward(
+        Pcr3bp::RegBasicObjects<MapT>& basic_objects,
+        unsigned order,
+        CoveringRelationVerdict& verdict,
+        std::ostream& log,
         CapdUtils::LocalCoordinateSystem<MapT> coordsys_src,
         CapdUtils::LocalCoordinateSystem<MapT> coordsys_dst,
         bool src_specialized = false,
-        bool dst_specialized = false)
+        bool dst_specialized = false,
+        const CapdUtils::StepSchedule* step_schedule = nullptr) const
     {
-        ScaledLocalPoincare4_Map<MapT> f
+        const CoveringRelationCheck cr = [&]() -> CoveringRelationCheck
         {
-            std::ref(this->m_basic_objects.m_vf_reg_pos2),
-            std::ref(this->m_basic_objects.m_hamiltonian_reg2),
-            this->m_basic_objects.m_order,
-            coordsys_src,
-            coordsys_dst,
-            this->m_gain_factor,
-            src_specialized,
-            dst_specialized
-        };
+            auto map_factory = [&]()
+            {
+                return std::make_unique<ScaledLocalPoincare4_MapInstance<MapT>>(
+                    basic_objects.get_pools(),
+                    Direction::Positive,
+                    order,
+                    coordsys_src,
+                    coordsys_dst,
+                    this->m_gain_factor,
+                    src_specialized,
+                    dst_specialized,
+                    &this->m_context.get_psi0_coefficients(),
+                    this->m_energy_surface_reduction,
+                    step_schedule);
+            };
+
+            // specialized psi0 constraint evaluates the map shared by all instances (see ProofContext)
+            const unsigned max_worker_count = src_specialized ? 1 : this->m_max_check_worker_count;
+
+            if (this->m_refinement.max_depth > 0)
+            {
+                CoveringRelationRefinement refinement = this->m_refinement;
+                refinement.worker_count = std::min(refinement.worker_count, max_worker_count);
+
+                return CoveringRelationCheck { map_factory, refinement, log };
+            }
+
+            if (this->m_subdivision.grid_size > 1)
+            {
+                CoveringRelationSubdivision subdivision = this->m_subdivision;
+                subdivision.worker_count = std::min(subdivision.worker_count, max_worker_count);
+
+                return CoveringRelationCheck { map_factory, subdivision, log };
+            }
+
+            ScaledLocalPoincare4_Map<MapT> f
+            {
+                basic_objects.m_vf_reg_pos2,
+                std::ref(basic_objects.m_hamiltonian_reg2),
+                order,
+                coordsys_src,
+                coordsys_dst,
+                this->m_gain_factor,
+                src_specialized,
+                dst_specialized,
+                &this->m_context.get_psi0_coefficients(),
+                this->m_energy_surface_reduction ? &basic_objects.m_energy_surface_pos2 : nullptr,
+                step_schedule
+            };
+
+            if (this->m_energy_surface_reduction && !f.is_energy_surface_reduced())
+            {
+                log << "energy surface reduction not applicable\n";
+            }
 
-        CoveringRelationCheck cr { f };
+            return CoveringRelationCheck { f, log };
+        }();
 
-        const ScalarType time_span = f.get_last_evaluation_return_time();
+        const ScalarType time_span = cr.get_return_time();
 
-        EXPECT_TRUE(cr.contraction_condition());
-        EXPECT_TRUE(cr.expansion_condition());
+        verdict.contraction_condition = cr.contraction_condition();
+        verdict.expansion_condition = cr.expansion_condition();
 
         // check that image is properly covered by its coordinate system
         LocalPoincare4_Constraint<MapT> extension_to_4_dst
         {
-            std::ref(this->m_basic_objects.m_hamiltonian_reg2),
+            std::ref(basic_objects.m_hamiltonian_reg2),
             std::ref(coordsys_dst)
         };
 
@@ -181,33 +426,38 @@ private:
     }
 
     void simple_collision_avoidance_check(
+        Pcr3bp::RegBasicObjects<MapT>& basic_objects,
+        unsigned order,
+        CoveringRelationVerdict& verdict,
+        std::ostream& log,
         CapdUtils::LocalCoordinateSystem<MapT> coordsys_src,
         CapdUtils::LocalCoordinateSystem<MapT> coordsys_dst,
-        ScalarType time_span)
+        ScalarType time_span,
+        unsigned worker_count) const
     {
         LocalPoincare4_Constraint<MapT> extension_to_4_src
         {
-            std::ref(this->m_basic_objects.m_hamiltonian_reg2),
+            std::ref(basic_objects.m_hamiltonian_reg2),
             std::ref(coordsys_src)
         };
 
         // check that image is properly covered by its coordinate system
         LocalPoincare4_Constraint<MapT> extension_to_4_dst
         {
-            std::ref(this->m_basic_objects.m_hamiltonian_reg2),
+            std::ref(basic_objects.m_hamiltonian_reg2),
             std::ref(coordsys_dst)
         };
 
         CapdUtils::MaxNorm<MapT> norm {};
 
-        const VectorType expected_collision = this->m_basic_objects.m_parameters.get_initial_point();
+        const VectorType expected_collision = basic_objects.m_parameters.get_initial_point();
         if ( norm(coordsys_src.get_origin() - expected_collision) < norm(coordsys_dst.get_origin() - expected_collision) )
         {
             ScaledLocalPoincare4_Map<MapT> f_pos
             {
-                std::ref(this->m_basic_objects.m_vf_reg_pos2),
-                std::ref(this->m_basic_objects.m_hamiltonian_reg2),
-                this->m_basic_objects.m_order,
+                basic_objects.m_vf_reg_pos2,
+                std::ref(basic_objects.m_hamiltonian_reg2),
+                order,
                 coordsys_src,
                 coordsys_dst,
                 this->m_gain_factor,
@@ -218,16 +468,15 @@ private:
             SolutionCurveWithConditionCheck<MapT> solution_curve {};
             f_pos(N, time_span, solution_curve);
 
-            bool const solution_curve_condition = solution_curve.is_condition_never_satisfied( this->m_basic_objects.m_collision_condition );
-            EXPECT_TRUE(solution_curve_condition);
+            verdict.collision_avoidance_condition = solution_curve.is_condition_never_satisfied( basic_objects.m_collision_condition, 1e-15, log, worker_count );
         }
         else
         {
             ScaledLocalPoincare4_Map<MapT> f_neg
             {
-                std::ref(this->m_basic_objects.m_vf_reg_neg2),
-                std::ref(this->m_basic_objects.m_hamiltonian_reg2),
-                this->m_basic_objects.m_order,
+                basic_objects.m_vf_reg_neg2,
+                std::ref(basic_objects.m_hamiltonian_reg2),
+                order,
                 coordsys_dst,
                 coordsys_src,
                 this->m_gain_factor,
@@ -238,8 +487,7 @@ private:
             SolutionCurveWithConditionCheck<MapT> solution_curve {};
             f_neg(N, time_span, solution_curve);
 
-            bool const solution_curve_condition = solution_curve.is_condition_never_satisfied( this->m_basic_objects.m_collision_condition );
-            EXPECT_TRUE(solution_curve_condition);
+            verdict.collision_avoidance_condition = solution_curve.is_condition_never_satisfied( basic_objects.m_collision_condition, 1e-15, log, worker_count );
         }
     }
 };
@@ -14,7 +14,7 @@ TEST(Pcr3bp_proof, parallelogram_coverings_derivative)
 
     capd::rounding::DoubleRounding::roundNearest();
 
-    CoveringRelationsSetup setup {};
-    CoveringRelationsTest_ParallelogramCoveringDerivativeCheck<IMap> test { setup };
+    ProofContext<IMap> context {};
+    CoveringRelationsTest_ParallelogramCoveringDerivativeCheck<IMap> test { context };
     test.parallelogram_covering_derivative_check();
 }
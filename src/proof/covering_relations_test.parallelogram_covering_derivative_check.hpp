@@ -6,7 +6,7 @@
 
 #include "tools/test_tools.hpp"
 
-#include "tools/auxiliary_functions.hpp"
+#include "tools/generated_maps.hpp"
 
 #include "covering_relations_test_base.hpp"
 #include "covering_relation_checker.hpp"
@@ -14,6 +14,9 @@
 
 #include "scaled_local_poincare4_map.hpp"
 
+#include <iostream>
+#include <list>
+
 namespace Pcr3bpProof
 {
 
@@ -27,19 +30,21 @@ public:
 
     using Coordsys = CapdUtils::LocalCoordinateSystem<MapT>;
 
-    CoveringRelationsTest_ParallelogramCoveringDerivativeCheck(const CoveringRelationsSetup& setup)
-        : CoveringRelationsTestBase<MapT>(setup)
+    CoveringRelationsTest_ParallelogramCoveringDerivativeCheck(ProofContext<MapT>& context)
+        : CoveringRelationsTestBase<MapT>(context)
     {}
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //! @brief Check parallelogram coverings around fixed point
+    //!
+    //! @param log stream of the derivatives of the Poincare maps between the periodic orbit coordsys
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    void parallelogram_covering_derivative_check()
+    void parallelogram_covering_derivative_check(std::ostream& log = std::cout)
     {
         const ScalarType L = this->m_basic_objects.m_parallelogram_coverings_parameters.L;
 
-        MapT eta = AuxiliaryFunctions<MapT>::eta( L );
-        MapT eta_inverse = AuxiliaryFunctions<MapT>::eta( -L );
+        auto eta = GeneratedMaps<MapT>::eta( L );
+        auto eta_inverse = GeneratedMaps<MapT>::eta( -L );
 
         std::list<MatrixType> der_list {};
         for (int i = 0; i < 4; ++i)
@@ -52,14 +57,15 @@ public:
                 this->m_basic_objects.m_vf_reg_pos2,
                 this->m_basic_objects.m_hamiltonian_reg2,
                 this->m_basic_objects.m_order,
-                this->m_periodic_orbit_coordsys.at(first),
-                this->m_periodic_orbit_coordsys.at(second),
+                this->get_periodic_orbit_coordsys().at(first),
+                this->get_periodic_orbit_coordsys().at(second),
                 this->m_gain_factor,
                 first == 0,
-                second == 0
+                second == 0,
+                &this->m_context.get_psi0_coefficients()
             };
 
-            CapdUtils::CompositeMap<MapT, MapT&, decltype(poincare)&, MapT&> aligned_poincare
+            CapdUtils::CompositeMap<MapT, decltype(eta)&, decltype(poincare)&, decltype(eta_inverse)&> aligned_poincare
             {
                 std::ref(eta),
                 std::ref(poincare),
@@ -68,7 +74,7 @@ public:
 
             MatrixType der(2,2);
             aligned_poincare(N, der);
-            print_var(der);
+            print_var_to(log, der);
 
             der_list.emplace_back(der);
         }
@@ -81,7 +87,7 @@ public:
             der_union = capd::vectalg::intervalHull(*it, der_union);
         }
 
-        print_var(der_union);
+        print_var_to(log, der_union);
 
         ParallelogramCoveringChecker<MapT> parallelogram_covering_checker( der_union );
     }
@@ -4,7 +4,13 @@
 
 #pragma once
 
-#include "covering_relations_setup.hpp"
+#include "proof_context.hpp"
+#include "covering_relation_checker.hpp"
+#include "taylor_order_selection.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 
 namespace Pcr3bpProof
 {
@@ -12,6 +18,89 @@ namespace Pcr3bpProof
 template<typename MapT>
 class CoveringRelationsTestBase
 {
+public:
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Set subdivision of the h-sets used in the covering relation checks
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void set_subdivision(const CoveringRelationSubdivision& subdivision) noexcept
+    {
+        m_subdivision = subdivision;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Set adaptive refinement of the h-sets used in the covering relation checks (takes precedence over subdivision)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void set_refinement(const CoveringRelationRefinement& refinement) noexcept
+    {
+        m_refinement = refinement;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Set number of threads used by the collision avoidance checks of periodic and jump coverings
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void set_collision_check_worker_count(unsigned worker_count) noexcept
+    {
+        m_collision_check_worker_count = worker_count;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Limit number of threads of a single covering relation check (subdivision or refinement)
+    //! @details The worker counts of the checks are read from the environment, the limit keeps them from multiplying with
+    //!          the number of concurrently verified stages.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void set_max_check_worker_count(unsigned worker_count) noexcept
+    {
+        m_max_check_worker_count = worker_count > 0 ? worker_count : 1;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Set Taylor orders of the covering relation checks along homoclinic orbit
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void set_taylor_orders(const TaylorOrderTable& taylor_orders)
+    {
+        m_taylor_orders = taylor_orders;
+    }
+
+    const TaylorOrderTable& get_taylor_orders() const noexcept
+    {
+        return m_taylor_orders;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Enable integration of the vector field reduced to the energy surface in the forward covering relation checks
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void set_energy_surface_reduction(bool enabled) noexcept
+    {
+        m_energy_surface_reduction = enabled;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Read PCR3BP_ENERGY_SURFACE environment variable (reduction enabled if set to a value other than 0)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static bool energy_surface_reduction_from_environment()
+    {
+        const char* env = std::getenv("PCR3BP_ENERGY_SURFACE");
+        return env && std::strcmp(env, "") != 0 && std::strcmp(env, "0") != 0;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Enable replay of the time steps recorded by the setup in the homoclinic covering relation checks
+    //! @details Used by interval maps only (see StepReplayPoincareMap), maps reduced to the energy surface do not replay.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void set_step_replay(bool enabled) noexcept
+    {
+        m_step_replay = enabled;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Read PCR3BP_STEP_REPLAY environment variable (replay enabled if set to a value other than 0)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static bool step_replay_from_environment()
+    {
+        const char* env = std::getenv("PCR3BP_STEP_REPLAY");
+        return env && std::strcmp(env, "") != 0 && std::strcmp(env, "0") != 0;
+    }
+
 protected:
     using ScalarType = typename MapT::ScalarType;
     using VectorType = typename MapT::VectorType;
@@ -19,18 +108,51 @@ protected:
 
     using Coordsys = CapdUtils::LocalCoordinateSystem<MapT>;
 
-    CoveringRelationsTestBase(const CoveringRelationsSetup& setup)
-        : m_periodic_orbit_coordsys(setup.get_periodic_orbit_coordsys())
-        , m_homoclinic_orbit_coordsys(setup.get_homoclinic_orbit_coordsys())
+    CoveringRelationsTestBase(ProofContext<MapT>& context)
+        : m_basic_objects(context.get_pools())
+        , m_context(context)
+        , m_setup(context.get_setup())
     {}
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Get periodic orbit coordsys (in pipelined setup waits only for the periodic orbit stage)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    const std::vector<Coordsys>& get_periodic_orbit_coordsys() const
+    {
+        return m_setup.get_periodic_orbit_coordsys();
+    }
+
+    const std::vector<Coordsys>& get_homoclinic_orbit_coordsys() const
+    {
+        return m_setup.get_homoclinic_orbit_coordsys();
+    }
+
+    //! Time steps from homoclinic orbit coordsys src_idx to src_idx+1, nullptr if the replay is disabled
+    const CapdUtils::StepSchedule* get_homoclinic_step_schedule(size_t src_idx) const
+    {
+        return m_step_replay ? &m_setup.get_homoclinic_step_schedules().at(src_idx) : nullptr;
+    }
+
 
-    Pcr3bp::RegBasicObjects<MapT> m_basic_objects {};
+    // own maps leased from the pools of the context, so that tests of the same context may run concurrently
+    Pcr3bp::RegBasicObjects<MapT> m_basic_objects;
 
-    const std::vector<Coordsys> m_periodic_orbit_coordsys;
-    const std::vector<Coordsys> m_homoclinic_orbit_coordsys;
+    // fixed order of the basic objects unless calibrated or set
+    TaylorOrderTable m_taylor_orders { m_basic_objects.m_order };
+
+    ProofContext<MapT>& m_context;
+    const CoveringRelationsSetup& m_setup;
 
     const ScalarType m_gain_factor { 85e-11 };
+
+    CoveringRelationSubdivision m_subdivision { CoveringRelationSubdivision::from_environment() };
+    CoveringRelationRefinement m_refinement { CoveringRelationRefinement::from_environment() };
+
+    unsigned m_collision_check_worker_count { ParallelExecutor::get_default_worker_count() };
+    unsigned m_max_check_worker_count { std::numeric_limits<unsigned>::max() };
+
+    bool m_energy_surface_reduction { energy_surface_reduction_from_environment() };
+    bool m_step_replay { step_replay_from_environment() };
 };
 
 }
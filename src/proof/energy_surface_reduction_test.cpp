@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "tools/test_tools.hpp"
+#include "tools/affine_poincare_map.hpp"
+#include "tools/energy_surface_poincare_map.hpp"
+
+#include <capd_utils/timemap_wrapper.hpp>
+
+#include "pcr3bp_reg_basic_objects.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Consistency check of the vector field reduced to the energy surface with the full vector field: the chart and the
+//!        lift, the vector fields, the timemaps and the Poincare maps onto a section perpendicular to the flow
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_energy_surface_reduction, consistency)
+{
+    using namespace Pcr3bpProof;
+
+    Pcr3bp::RegBasicObjects<RMap> basic_objects {};
+
+    RMap vector_field = Pcr3bp::RegularizedSystem<RMap>::createPositiveVectorField4(2, basic_objects.m_setup, basic_objects.m_h0);
+    CapdUtils::TimemapWrapper<RMap> timemap { vector_field, 0.0, basic_objects.m_order };
+
+    auto max_difference = [](const RVector& lhs, const RVector& rhs)
+    {
+        double ret = 0.0;
+        for (size_t i = 0; i < lhs.dimension(); ++i)
+        {
+            ret = std::max(ret, std::fabs(lhs[i] - rhs[i]));
+        }
+        return ret;
+    };
+
+    const double time = 0.3;
+
+    const RVector src_origin = basic_objects.m_parameters.get_intermediate_point();
+    timemap.set_time(time);
+    const RVector dst_origin = timemap(src_origin);
+
+    // section perpendicular to the flow at dst_origin
+    RVector normal = vector_field(dst_origin);
+    normal /= std::sqrt(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2] + normal[3]*normal[3]);
+
+    const Pcr3bp::EnergySurfaceReduction<RMap>& reduction = basic_objects.m_energy_surface_pos2;
+    const auto chart = reduction.create_chart(src_origin, dst_origin, normal);
+    ASSERT_TRUE(chart.has_value());
+
+    RMap reduced_vector_field = reduction.create_vector_field(*chart);
+    RMap chart_map = reduction.create_chart_map(*chart);
+    RMap lift = reduction.create_lift(*chart);
+    RMap branch_function = reduction.create_branch_function(*chart);
+
+    const RVector src_reduced = chart_map(src_origin);
+    EXPECT_LT(max_difference(lift(src_reduced), src_origin), 1e-10);
+
+    const RVector field = vector_field(src_origin);
+    const RVector projected_field { field[0], field[1], field[2]*chart->n3 + field[3]*chart->n4 };
+    EXPECT_LT(max_difference(reduced_vector_field(src_reduced), projected_field), 1e-9);
+
+    CapdUtils::TimemapWrapper<RMap> reduced_timemap { reduced_vector_field, time, basic_objects.m_order };
+    EXPECT_LT(max_difference(lift(reduced_timemap(src_reduced)), dst_origin), 1e-9);
+
+    // the directions of the destination coordinate system are the normal and the unit vectors other than the one closest to it
+    size_t normal_index = 0;
+    for (size_t i = 1; i < 4; ++i)
+    {
+        if (std::fabs(normal[i]) > std::fabs(normal[normal_index]))
+        {
+            normal_index = i;
+        }
+    }
+
+    RMatrix dst_directions = RMatrix::Identity(4);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        dst_directions[i][normal_index] = dst_directions[i][2];
+        dst_directions[i][2] = normal[i];
+    }
+
+    const CapdUtils::LocalCoordinateSystem<RMap> src_coordsys { src_origin, RMatrix::Identity(4) };
+    const CapdUtils::LocalCoordinateSystem<RMap> dst_coordsys { dst_origin, dst_directions };
+
+    CapdUtils::AffinePoincareMap<RMap> poincare { vector_field, basic_objects.m_order, src_coordsys, dst_coordsys };
+    CapdUtils::EnergySurfacePoincareMap<RMap> reduced_poincare {
+        reduced_vector_field, chart_map, lift, branch_function, basic_objects.m_order, src_coordsys, dst_coordsys };
+
+    RMatrix der(4, 4);
+    RMatrix reduced_der(4, 4);
+    const RVector img = poincare(RVector(4), der);
+    const RVector reduced_img = reduced_poincare(RVector(4), reduced_der);
+
+    EXPECT_LT(max_difference(img, reduced_img), 1e-9);
+    EXPECT_LT(std::fabs(poincare.get_last_evaluation_return_time() - reduced_poincare.get_last_evaluation_return_time()), 1e-9);
+
+    // the derivatives agree on the tangent space of the energy surface
+    const RVector gradient = basic_objects.m_hamiltonian_reg2_grad(src_origin);
+    for (size_t j = 0; j < 4; ++j)
+    {
+        RVector tangent(4);
+        tangent[j] = 1.0;
+        tangent -= gradient * (gradient[j] / (gradient * gradient));
+
+        EXPECT_LT(max_difference(der * tangent, reduced_der * tangent), 1e-8);
+    }
+
+    // the other root of the Hamiltonian along k = (-n4, n3) has the same chart coordinates, it is rejected
+    const double k_derivative = -gradient[2]*chart->n4 + gradient[3]*chart->n3;
+    const double t = -2.0 * k_derivative / (chart->n3*chart->n3 + chart->n4*chart->n4);
+    const RVector other_root { 0.0, 0.0, -t*chart->n4, t*chart->n3 };
+
+    EXPECT_GT(branch_function(src_origin)[0], 0.0);
+    EXPECT_LT(branch_function(other_root + src_origin)[0], 0.0);
+    EXPECT_LT(max_difference(chart_map(other_root + src_origin), src_reduced), 1e-10);
+    EXPECT_THROW(reduced_poincare(other_root), std::domain_error);
+}
@@ -0,0 +1,21 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "full_proof_test.hpp"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Complete interval arithmetic validation (Theorem 7, Theorem 8, Lemma 8, Lemma 10 and Lemma 11) with all stages
+//!        executed concurrently on top of a single covering relations setup
+//!
+//!        The number of worker threads may be set with PCR3BP_WORKER_COUNT environment variable.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_full_proof, all_stages)
+{
+    using namespace Pcr3bpProof;
+
+    capd::rounding::DoubleRounding::roundNearest();
+
+    FullProofTaskGraph full_proof { ParallelExecutor::get_default_worker_count() };
+    full_proof.run();
+}
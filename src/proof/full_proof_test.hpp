@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "tools/test_tools.hpp"
+#include "tools/task_graph.hpp"
+#include "tools/parallel_executor.hpp"
+
+#include "periodic_orbit_parameters_test.hpp"
+#include "covering_relations_test.hpp"
+#include "covering_relations_test.parallelogram_covering_derivative_check.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief All verification stages of the proof arranged as a task graph
+//! @details The proof context (covering relations setup and psi0 coefficients) is created once, with the setup in pipelined
+//!          mode, and shared by all stages that depend on it. The periodic orbit and homoclinic orbit origins stages of the
+//!          setup are separate graph nodes, so they run concurrently, and the periodic coverings are verified while the
+//!          homoclinic orbit coordsys are generated. Every stage leases its own basic objects from the pools of the context,
+//!          so the stages may run concurrently. The homoclinic covering relations are distributed over several graph nodes
+//!          that pull coordsys pairs from a common counter.
+//!
+//!          The stages buffer their logs (in verdicts or in string streams of the graph), which are printed in a fixed order
+//!          after the graph is run, so no stage writes to std::cout or changes its format while other stages run. The threads
+//!          of a single covering relation check are limited, so the checks of concurrent stages do not oversubscribe the
+//!          machine.
+//!
+//!          The stages that use the specialized psi0 maps (periodic coverings and parallelogram covering derivative check)
+//!          share the internal psi0 map of the proof context, hence they are ordered by an additional dependency.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class FullProofTaskGraph
+{
+public:
+    using MapT = IMap;
+
+    using BasicObjects = Pcr3bp::RegBasicObjects<MapT>;
+
+    explicit FullProofTaskGraph(unsigned worker_count)
+        : m_worker_count(worker_count > 0 ? worker_count : 1)
+        , m_max_check_worker_count(std::max(1u, ParallelExecutor::get_default_worker_count() / m_worker_count))
+    {
+        m_context = std::make_unique<ProofContext<MapT>>(CoveringRelationsSetup::Mode::Pipelined);
+
+        const TaskGraph::TaskId periodic_setup_id = m_graph.add_task("periodic orbit coordsys", [this]()
+        {
+            m_context->get_setup().get_periodic_orbit_coordsys();
+        });
+
+        const TaskGraph::TaskId origins_setup_id = m_graph.add_task("homoclinic orbit origins", [this]()
+        {
+            m_context->get_setup().get_homoclinic_orbit_origins();
+        });
+
+        const TaskGraph::TaskId homoclinic_setup_id = m_graph.add_task("homoclinic orbit coordsys", [this]()
+        {
+            m_homoclinic_test = std::make_unique<CoveringRelationsTest<MapT>>(*m_context);
+            m_homoclinic_test->set_max_check_worker_count(m_max_check_worker_count);
+
+            const size_t pair_count = m_context->get_setup().get_homoclinic_orbit_coordsys().size() - 1;
+            m_homoclinic_verdicts.resize(pair_count);
+        }, { periodic_setup_id, origins_setup_id });
+
+        for (unsigned k = 0; k < m_worker_count; ++k)
+        {
+            m_graph.add_task("homoclinic coverings (worker " + std::to_string(k) + ")", [this]()
+            {
+                check_homoclinic_coverings();
+            }, { homoclinic_setup_id });
+        }
+
+        const TaskGraph::TaskId periodic_id = m_graph.add_task("periodic coverings", [this]()
+        {
+            CoveringRelationsTest<MapT> test { *m_context };
+            test.set_collision_check_worker_count(1);
+            test.set_max_check_worker_count(m_max_check_worker_count);
+            m_periodic_verdicts = { test.check_periodic_covering(0), test.check_periodic_covering(1) };
+        }, { periodic_setup_id });
+
+        m_graph.add_task("jump coverings", [this]()
+        {
+            CoveringRelationsTest<MapT> test { *m_context };
+            test.set_collision_check_worker_count(1);
+            test.set_max_check_worker_count(m_max_check_worker_count);
+            m_jump_verdict = test.check_jump_covering();
+        }, { homoclinic_setup_id });
+
+        m_graph.add_task("parallelogram coverings beginning", [this]()
+        {
+            CoveringRelationsTest<MapT> test { *m_context };
+            m_parallelogram_beginning_verdict = test.check_parallelogram_covering_beginning();
+        }, { homoclinic_setup_id });
+
+        m_graph.add_task("parallelogram coverings derivative", [this]()
+        {
+            CoveringRelationsTest_ParallelogramCoveringDerivativeCheck<MapT> test { *m_context };
+            m_parallelogram_derivative_log.precision(std::cout.precision());
+            test.parallelogram_covering_derivative_check(m_parallelogram_derivative_log);
+        }, { periodic_setup_id, periodic_id });
+
+        m_graph.add_task("periodic orbit parameters", [this]()
+        {
+            LyapunovOrbitRegCollisionSetup<MapT> setup( 58696.0 / 65536, true, m_periodic_orbit_parameters_log );
+        });
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Run all stages, report covering verdicts in a fixed order and print stage timings
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void run()
+    {
+        // the logs of the stages take the precision of std::cout, it is set before any stage runs
+        std::cout.precision(15);
+
+        try
+        {
+            m_graph.run(m_worker_count);
+        }
+        catch (...)
+        {
+            m_graph.print_summary(std::cout);
+            throw;
+        }
+
+        for (const CoveringRelationVerdict& verdict : m_periodic_verdicts)
+        {
+            verdict.report();
+        }
+
+        m_jump_verdict.report();
+        m_parallelogram_beginning_verdict.report();
+        std::cout << m_parallelogram_derivative_log.str();
+
+        for (const CoveringRelationVerdict& verdict : m_homoclinic_verdicts)
+        {
+            verdict.report();
+        }
+
+        std::cout << m_periodic_orbit_parameters_log.str();
+
+        m_graph.print_summary(std::cout);
+    }
+
+private:
+    void check_homoclinic_coverings()
+    {
+        BasicObjects basic_objects { m_context->get_pools() };
+
+        for (size_t i = m_next_homoclinic_pair++; i < m_homoclinic_verdicts.size(); i = m_next_homoclinic_pair++)
+        {
+            m_homoclinic_verdicts.at(i) = m_homoclinic_test->check_homoclinic_covering(basic_objects, i);
+        }
+    }
+
+    const unsigned m_worker_count;
+    const unsigned m_max_check_worker_count;
+
+    TaskGraph m_graph {};
+
+    std::unique_ptr<ProofContext<MapT>> m_context {};
+    std::unique_ptr<CoveringRelationsTest<MapT>> m_homoclinic_test {};
+
+    std::vector<CoveringRelationVerdict> m_periodic_verdicts {};
+    CoveringRelationVerdict m_jump_verdict {};
+    CoveringRelationVerdict m_parallelogram_beginning_verdict {};
+    std::vector<CoveringRelationVerdict> m_homoclinic_verdicts {};
+
+    std::stringstream m_parallelogram_derivative_log {};
+    std::stringstream m_periodic_orbit_parameters_log {};
+    std::atomic<size_t> m_next_homoclinic_pair { 0 };
+};
+
+}
@@ -0,0 +1,206 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "tools/test_tools.hpp"
+
+#include "pcr3bp_reg_basic_objects.hpp"
+#include "codegen/generated_map.hpp"
+#include "tools/generated_maps.hpp"
+
+#include <pcr3bp_generated_evaluators.hpp>
+
+#include <initializer_list>
+#include <vector>
+
+namespace
+{
+
+using namespace Pcr3bpProof;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Check that the values and the derivatives of both maps at x0 intersect
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename GeneratedT, typename ReferenceT>
+void expect_same_map(GeneratedT& generated, ReferenceT& reference, const IVector& x0)
+{
+    ASSERT_EQ( generated.dimension(), reference.dimension() );
+    ASSERT_EQ( generated.imageDimension(), reference.imageDimension() );
+
+    IMatrix der(generated.imageDimension(), generated.dimension());
+    IMatrix reference_der(reference.imageDimension(), reference.dimension());
+    const IVector value = generated(x0, der);
+    const IVector reference_value = reference(x0, reference_der);
+
+    IVector value_intersection(value.dimension());
+    EXPECT_TRUE( intersection(value, reference_value, value_intersection) );
+
+    IMatrix der_intersection(der.numberOfRows(), der.numberOfColumns());
+    EXPECT_TRUE( intersection(der, reference_der, der_intersection) );
+}
+
+IVector create_box(std::initializer_list<double> left_bounds)
+{
+    using ScalarType = IMap::ScalarType;
+
+    IVector ret(left_bounds.size());
+    unsigned i = 0;
+    for (double x : left_bounds)
+    {
+        ret[i++] = ScalarType(x, x + 1e-8);
+    }
+    return ret;
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Consistency check of the generated evaluators with the CAPD maps built from the same definitions
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_generated_evaluators, regularized_vector_field4)
+{
+    using namespace Pcr3bpProof;
+
+    capd::rounding::DoubleRounding::roundNearest();
+
+    using ScalarType = IMap::ScalarType;
+    using size_type = IMatrix::size_type;
+
+    const Pcr3bp::SetupParameters<IMap> setup {};
+    const ScalarType h0 = Pcr3bp::RegBasicObjects<IMap>{}.m_h0;
+
+    const size_type order = 20;
+
+    for (IMap reference : { Pcr3bp::RegularizedSystem<IMap>::createPositiveVectorField4(2, setup, h0),
+                            Pcr3bp::RegularizedSystem<IMap>::createNegativeVectorField4(2, setup, h0) })
+    {
+        Codegen::GeneratedMap<IMap, Generated::RegularizedVectorField4Evaluator> generated { reference };
+        reference.setOrder(order + 1);
+
+        const IVector x0 { ScalarType(0.3, 0.3 + 1e-10), ScalarType(0.2), ScalarType(0.5), ScalarType(-0.4) };
+
+        IMatrix der(4, 4);
+        IMatrix reference_der(4, 4);
+        const IVector value = generated(x0, der);
+        const IVector reference_value = reference(x0, reference_der);
+
+        IVector value_intersection(4);
+        EXPECT_TRUE( intersection(value, reference_value, value_intersection) );
+
+        IMatrix der_intersection(4, 4);
+        EXPECT_TRUE( intersection(der, reference_der, der_intersection) );
+
+        std::vector<IVector> coeffs(order + 1, IVector(4));
+        std::vector<IVector> reference_coeffs(order + 1, IVector(4));
+        coeffs.front() = x0;
+        reference_coeffs.front() = x0;
+
+        generated.computeODECoefficients(coeffs.data(), order);
+        reference.computeODECoefficients(reference_coeffs.data(), order);
+
+        for (size_type k = 0; k <= order; ++k)
+        {
+            IVector coeffs_intersection(4);
+            EXPECT_TRUE( intersection(coeffs.at(k), reference_coeffs.at(k), coeffs_intersection) );
+        }
+    }
+}
+
+TEST(Pcr3bp_generated_evaluators, levi_civita_coordinate_change)
+{
+    using namespace Pcr3bpProof;
+
+    capd::rounding::DoubleRounding::roundNearest();
+
+    const Pcr3bp::SetupParameters<IMap> setup {};
+
+    IMap reference = LeviCivitaCoordinateChange<IMap>::create(2, setup, true, true, false);
+    auto generated = GeneratedMaps<IMap>::levi_civita_change(2, setup);
+
+    expect_same_map(generated, reference, create_box({ 0.1, 0.2, 0.3, 0.4, 0.5 }));
+}
+
+TEST(Pcr3bp_generated_evaluators, levi_civita_coordinate_change_inverse)
+{
+    using namespace Pcr3bpProof;
+
+    capd::rounding::DoubleRounding::roundNearest();
+
+    const Pcr3bp::SetupParameters<IMap> setup {};
+    const double x0 = setup.get_x(2).leftBound();
+
+    IMap reference = LeviCivitaCoordinateChange<IMap>::createInverse(2, setup, true, true);
+    auto generated = GeneratedMaps<IMap>::levi_civita_change_inverse(2, setup);
+
+    expect_same_map(generated, reference, create_box({ x0 + 0.3, 0.2, 0.1, -0.4, -1.5 }));
+    expect_same_map(generated, reference, create_box({ x0 - 0.2, -0.3, 0.5, 0.2, -1.5 }));
+}
+
+TEST(Pcr3bp_generated_evaluators, levi_civita_inverse_coordinate_change_pieces)
+{
+    using namespace Pcr3bpProof;
+    using ScalarType = IMap::ScalarType;
+
+    capd::rounding::DoubleRounding::roundNearest();
+
+    const Pcr3bp::SetupParameters<IMap> setup {};
+    const ScalarType xi = setup.get_x(2);
+    const double x0 = xi.leftBound();
+
+    LeviCivitaInverseCoordinateChange<IMap> reference { xi };
+    GeneratedLeviCivitaInverseCoordinateChange<IMap> generated { xi };
+
+    // y > 0 and y < 0
+    expect_same_map(generated, reference, create_box({ x0 + 0.3, 0.2, 0.1, -0.4, -1.5 }));
+    expect_same_map(generated, reference, create_box({ x0 - 0.2, -0.3, 0.5, 0.2, -1.5 }));
+
+    // y = 0 on both sides of xi
+    IVector x_right = create_box({ x0 + 0.3, 0.0, 0.1, -0.4, -1.5 });
+    IVector x_left = create_box({ x0 - 0.3, 0.0, 0.1, -0.4, -1.5 });
+    x_right[1] = x_left[1] = ScalarType(0.0);
+
+    expect_same_map(generated, reference, x_right);
+    expect_same_map(generated, reference, x_left);
+}
+
+TEST(Pcr3bp_generated_evaluators, auxiliary_functions)
+{
+    using namespace Pcr3bpProof;
+
+    capd::rounding::DoubleRounding::roundNearest();
+
+    const IVector x0 = create_box({ 0.4, -0.1 });
+
+    IMap eta_reference = AuxiliaryFunctions<IMap>::eta(0.3);
+    auto eta = GeneratedMaps<IMap>::eta(0.3);
+    expect_same_map(eta, eta_reference, x0);
+
+    IMap r_inverse_reference = AuxiliaryFunctions<IMap>::R_Inverse(0.2, 0.7);
+    auto r_inverse = GeneratedMaps<IMap>::r_inverse(0.2, 0.7);
+    expect_same_map(r_inverse, r_inverse_reference, x0);
+
+    IMap j_reference = AuxiliaryFunctions<IMap>::J();
+    auto j = GeneratedMaps<IMap>::j();
+    expect_same_map(j, j_reference, x0);
+
+    IMap psi0_inverse_reference = AuxiliaryFunctions<IMap>::create_psi0_inverse({ 0.5, 2.0 });
+    auto psi0_inverse = GeneratedMaps<IMap>::psi0_inverse({ 0.5, 2.0 });
+    expect_same_map(psi0_inverse, psi0_inverse_reference, create_box({ 0.1, 0.0, -0.2, 0.3 }));
+}
+
+TEST(Pcr3bp_generated_evaluators, psi0_specialized)
+{
+    using namespace Pcr3bpProof;
+
+    capd::rounding::DoubleRounding::roundNearest();
+
+    const Pcr3bp::SetupParameters<IMap> setup {};
+    const IMap::ScalarType h0 = Pcr3bp::RegBasicObjects<IMap>{}.m_h0;
+
+    IMap reference = Psi0_specialized<IMap>::create(h0, setup);
+    auto generated = GeneratedMaps<IMap>::psi0_specialized(h0, setup);
+
+    // the derivative at 0 defines the psi0 coefficients (see Psi0_Coefficients)
+    expect_same_map(generated, reference, IVector(2));
+    expect_same_map(generated, reference, create_box({ 0.05, -0.02 }));
+}
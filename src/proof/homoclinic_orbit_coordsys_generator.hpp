@@ -7,11 +7,16 @@
 #include "tools/test_tools.hpp"
 
 #include "tools/affine_poincare_map.hpp"
+#include "tools/step_replay_poincare_map.hpp"
 #include "tools/coordsys4_alignment.hpp"
+#include "tools/parallel_executor.hpp"
 
 #include "pcr3bp_reg_basic_objects.hpp"
 #include "pcr3bp_reg2_initial_coordsys_generator.hpp"
 
+#include <memory>
+#include <vector>
+
 namespace Pcr3bpProof
 {
 
@@ -32,15 +37,23 @@ public:
 
     static_assert(std::is_same<MapT, RMap>::value);
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //!
+    //! @param pools maps of the setup parameters (see ProofContext), the worker threads lease their maps from them as well
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     HomoclinicOrbitCoordsysGenerator(
         const std::vector<Coordsys>& periodic_orbit_coordsys,
         const std::vector<VectorType>& homoclinic_orbit_orgins,
-        ScalarType total_expansion_factor)
+        ScalarType total_expansion_factor,
+        std::shared_ptr<Pcr3bp::RegMapPools<MapT>> pools)
             : m_periodic_orbit_coordsys(periodic_orbit_coordsys)
             , m_homoclinic_orbit_origins(homoclinic_orbit_orgins)
+            , m_basic_objects(std::move(pools))
     {
         const std::list<Coordsys> homoclinic_orbit_coordsys_initial = build_homoclinic_orbit_coordsys_initial();
         m_homoclinic_orbit_coordsys = build_homoclinic_orbit_coordsys(homoclinic_orbit_coordsys_initial, total_expansion_factor);
+        m_step_schedules = record_step_schedules();
     }
 
     const std::vector<Coordsys>& get_coordsys_container() const noexcept
@@ -48,6 +61,14 @@ public:
         return m_homoclinic_orbit_coordsys;
     }
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Time steps along the homoclinic orbit, the i-th schedule goes from coordsys i to the section of coordsys i+1
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    const std::vector<CapdUtils::StepSchedule>& get_step_schedules() const noexcept
+    {
+        return m_step_schedules;
+    }
+
 private:
     std::list<Coordsys> build_homoclinic_orbit_coordsys_initial()
     {
@@ -72,32 +93,13 @@ private:
         const std::list<Coordsys>& homoclinic_orbit_coordsys_initial,
         ScalarType total_expansion_factor)
     {
-        std::list<AffinePoincareMap> poincare_pos_list {};
-        std::list<AffinePoincareMap> poincare_neg_list {};
-        {
-            auto it = homoclinic_orbit_coordsys_initial.begin();
-            for (auto jt = std::next(it, 1); jt != homoclinic_orbit_coordsys_initial.end(); ++it, ++jt )
-            {
-                poincare_pos_list.emplace_back(
-                    std::ref(m_basic_objects.m_vf_reg_pos2),
-                    m_basic_objects.m_order,
-                    *it,
-                    *jt
-                );
-
-                poincare_neg_list.emplace_back(
-                    std::ref(m_basic_objects.m_vf_reg_neg2),
-                    m_basic_objects.m_order,
-                    *jt,
-                    *it
-                );
-            }
-            poincare_neg_list.reverse();
-        }
+        std::vector<MatrixType> poincare_pos_ders {};
+        std::vector<MatrixType> poincare_neg_ders {};
+        compute_poincare_ders(homoclinic_orbit_coordsys_initial, poincare_pos_ders, poincare_neg_ders);
 
-        const ScalarType expansion_factor = std::pow( total_expansion_factor, 0.5 / poincare_pos_list.size() );
+        const ScalarType expansion_factor = std::pow( total_expansion_factor, 0.5 / poincare_pos_ders.size() );
 
-        const std::list<VectorType> unstable_dirs_pos = get_unstable_dirs(poincare_pos_list, VectorType{ 1.0, 0.0, 0.0, 0.0 }, expansion_factor);
+        const std::list<VectorType> unstable_dirs_pos = get_unstable_dirs(poincare_pos_ders, VectorType{ 1.0, 0.0, 0.0, 0.0 }, expansion_factor);
 
         const Coordsys& coordsysK = *(homoclinic_orbit_coordsys_initial.rbegin());
         const VectorType unstable_dir_pos_wK_local = *(unstable_dirs_pos.rbegin());
@@ -109,7 +111,7 @@ private:
 
         const VectorType stable_dir_pos_wK_local = coordsysK_dirs * stable_dir_pos_wK;
 
-        std::list<VectorType> unstable_dirs_neg = get_unstable_dirs(poincare_neg_list, stable_dir_pos_wK_local, expansion_factor);
+        std::list<VectorType> unstable_dirs_neg = get_unstable_dirs(poincare_neg_ders, stable_dir_pos_wK_local, expansion_factor);
         unstable_dirs_neg.reverse();
         
         std::vector<Coordsys> ret {};
@@ -140,19 +142,91 @@ private:
         return ret;
     }
 
-    std::list<VectorType> get_unstable_dirs(std::list<AffinePoincareMap>& poincare_map_list, VectorType v, ScalarType expansion_factor)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Compute derivatives of the affine Poincare maps between consecutive coordsys at their origins
+    //! @details The derivatives do not depend on each other, so all of them are computed concurrently (every worker thread
+    //!          uses its own basic objects). The negative direction maps are ordered from the last coordsys to the first one.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void compute_poincare_ders(
+        const std::list<Coordsys>& homoclinic_orbit_coordsys_initial,
+        std::vector<MatrixType>& poincare_pos_ders,
+        std::vector<MatrixType>& poincare_neg_ders) const
     {
-        std::list<VectorType> ret {};
+        using BasicObjectsPtr = std::unique_ptr<Pcr3bp::RegBasicObjects<MapT>>;
+
+        const std::vector<Coordsys> coordsys(homoclinic_orbit_coordsys_initial.begin(), homoclinic_orbit_coordsys_initial.end());
+        const size_t map_count = coordsys.size() - 1;
+
+        poincare_pos_ders.assign(map_count, MatrixType(4,4));
+        poincare_neg_ders.assign(map_count, MatrixType(4,4));
+
         CapdUtils::MaxNorm<MapT> norm {};
 
-        for (AffinePoincareMap& poincare_map : poincare_map_list)
-        {
-            MatrixType der(4,4);
-            const VectorType val = poincare_map( VectorType(4), der );
+        ParallelExecutor executor {};
+        executor.run(
+            2 * map_count,
+            [this]() -> BasicObjectsPtr
+            {
+                return std::make_unique<Pcr3bp::RegBasicObjects<MapT>>(m_basic_objects.get_pools());
+            },
+            [&](BasicObjectsPtr& basic_objects, size_t task_idx)
+            {
+                const bool positive = task_idx < map_count;
+                const size_t i = positive ? task_idx : task_idx - map_count;
+
+                const size_t src_idx = positive ? i : map_count - i;
+                const size_t dst_idx = positive ? i + 1 : map_count - i - 1;
 
-            assert_with_exception( norm(val) < 9.7e-12 );
+                AffinePoincareMap poincare_map
+                {
+                    positive ? basic_objects->m_vf_reg_pos2 : basic_objects->m_vf_reg_neg2,
+                    basic_objects->m_order,
+                    coordsys.at(src_idx),
+                    coordsys.at(dst_idx)
+                };
 
-            auto v_init = v.euclNorm();
+                MatrixType& der = positive ? poincare_pos_ders.at(i) : poincare_neg_ders.at(i);
+                const VectorType val = poincare_map( VectorType(4), der );
+
+                assert_with_exception( norm(val) < 9.7e-12 );
+            });
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Record time steps of the positive direction trajectories between consecutive coordsys (see StepScheduleRecorder)
+    //! @details Only the origins are integrated (without variational equations), the schedules are recorded concurrently.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    std::vector<CapdUtils::StepSchedule> record_step_schedules() const
+    {
+        using BasicObjectsPtr = std::unique_ptr<Pcr3bp::RegBasicObjects<MapT>>;
+
+        std::vector<CapdUtils::StepSchedule> ret(m_homoclinic_orbit_coordsys.size() - 1);
+
+        ParallelExecutor executor {};
+        executor.run(
+            ret.size(),
+            [this]() -> BasicObjectsPtr
+            {
+                return std::make_unique<Pcr3bp::RegBasicObjects<MapT>>(m_basic_objects.get_pools());
+            },
+            [&](BasicObjectsPtr& basic_objects, size_t i)
+            {
+                ret.at(i) = CapdUtils::StepScheduleRecorder<MapT>::record(
+                    basic_objects->m_vf_reg_pos2,
+                    basic_objects->m_order,
+                    m_homoclinic_orbit_coordsys.at(i),
+                    m_homoclinic_orbit_coordsys.at(i + 1));
+            });
+
+        return ret;
+    }
+
+    std::list<VectorType> get_unstable_dirs(const std::vector<MatrixType>& poincare_ders, VectorType v, ScalarType expansion_factor) const
+    {
+        std::list<VectorType> ret {};
+
+        for (const MatrixType& der : poincare_ders)
+        {
             v = der * v;
             v /= expansion_factor;
 
@@ -165,9 +239,10 @@ private:
     const std::vector<Coordsys>& m_periodic_orbit_coordsys;
     const std::vector<VectorType>& m_homoclinic_orbit_origins;
 
-    Pcr3bp::RegBasicObjects<MapT> m_basic_objects {};
+    Pcr3bp::RegBasicObjects<MapT> m_basic_objects;
 
     std::vector<Coordsys> m_homoclinic_orbit_coordsys {};
+    std::vector<CapdUtils::StepSchedule> m_step_schedules {};
 };
 
 }
@@ -27,8 +27,16 @@ public:
     using VectorType = typename MapT::VectorType;
     using MatrixType = typename MapT::MatrixType;
 
-    HomoclinicOrbitOriginsGenerator(const HomoclinicOrbitOriginsInitial<MapT>& homoclinic_orbit_origins_initial)
-        : m_homoclinic_orbit_origins_initial(homoclinic_orbit_origins_initial)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //!
+    //! @param pools maps of the setup parameters (see ProofContext)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    HomoclinicOrbitOriginsGenerator(
+        const HomoclinicOrbitOriginsInitial<MapT>& homoclinic_orbit_origins_initial,
+        std::shared_ptr<Pcr3bp::RegMapPools<MapT>> pools)
+            : m_homoclinic_orbit_origins_initial(homoclinic_orbit_origins_initial)
+            , m_basic_objects(std::move(pools))
     {
         const std::vector<VectorType>& initial_origins = homoclinic_orbit_origins_initial.get_points();
 
@@ -80,7 +88,7 @@ public:
 private:
     const HomoclinicOrbitOriginsInitial<MapT>& m_homoclinic_orbit_origins_initial;
 
-    Pcr3bp::RegBasicObjects<MapT> m_basic_objects {};
+    Pcr3bp::RegBasicObjects<MapT> m_basic_objects;
 
     CapdUtils::CoordinateSection<MapT> m_v_section { 4, 1, ScalarType(0.0) };
     CapdUtils::PoincareWrapper<MapT, decltype(m_v_section)> m_poincare_pos
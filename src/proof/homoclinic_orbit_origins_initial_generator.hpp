@@ -9,9 +9,13 @@
 
 #include <tools/auxiliary_functions.hpp>
 #include <tools/local_poincare4_constraint.hpp>
+#include <tools/concurrent_parallel_shooting.hpp>
 
 #include "periodic_orbit_coordsys_generator.hpp"
 
+#include <memory>
+#include <tuple>
+
 namespace Pcr3bpProof
 {
 
@@ -62,7 +66,7 @@ private:
             ret.push_back(v);
         }
 
-        const VectorType mid_v = m_poincare_pos_3( CapdUtils::Extract<MapT>::get_vector(root, root.dimension()-3, 3) );
+        const VectorType mid_v = m_segments.m_poincare_pos_3( CapdUtils::Extract<MapT>::get_vector(root, root.dimension()-3, 3) );
         const VectorType mid_v4 = VectorType{ mid_v[0], 0.0, mid_v[1], mid_v[2] };
         ret.push_back(mid_v4);
 
@@ -115,6 +119,68 @@ private:
         return dir.euclNorm();
     }
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Maps of the parallel shooting segments, every worker thread evaluates its own instance
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct ShootingSegments
+    {
+        explicit ShootingSegments(const Coordsys& coordsys_0) : m_coordsys_0(coordsys_0)
+        {}
+
+        auto get_segments()
+        {
+            return std::tie(
+                m_init,
+                m_poincare_pos_3,
+                m_poincare_pos_3,
+                m_poincare_pos_3,
+                m_poincare_pos_3,
+                m_poincare_pos_3,
+                m_poincare_pos_3,
+                m_poincare_pos_1);
+        }
+
+        Pcr3bp::RegBasicObjects<MapT> m_basic_objects {};
+
+        CapdUtils::LocalCoordinateSystem<MapT> m_coordsys_0;
+
+        CapdUtils::AffineMap<MapT> m_affine_0 { m_coordsys_0 };
+
+        LocalPoincare4_Constraint<MapT> m_extension_to_4
+        {
+            m_basic_objects.m_hamiltonian_reg2,
+            m_coordsys_0
+        };
+
+        CapdUtils::CompositeMap<MapT, MapT, decltype(m_extension_to_4)&, decltype(m_affine_0)&, MapT> m_init{ 
+            CapdUtils::ExtensionMap<MapT>::create({ 0, -1 }),
+            std::ref(m_extension_to_4),
+            std::ref(m_affine_0),
+            CapdUtils::ProjectionMap<MapT>::create(4, { 0, 2, 3 }) };
+
+        CapdUtils::CoordinateSection<MapT> m_v_section { 4, 1, ScalarType(0.0) };
+        CapdUtils::PoincareWrapper<MapT, decltype(m_v_section)> m_poincare_pos
+        {
+            m_basic_objects.m_vf_reg_pos2,
+            m_basic_objects.m_order,
+            m_v_section
+        };
+
+        CapdUtils::ENP<MapT, decltype(m_poincare_pos)&> m_poincare_pos_3{ 
+            { 0.0, 0.0, 0.0, 0.0 },
+            { 0, -1, 1, 2 },
+            { 0, 2, 3 },
+            std::ref(m_poincare_pos)
+        };
+
+        CapdUtils::ENP<MapT, decltype(m_poincare_pos)&> m_poincare_pos_1{ 
+            { 0.0, 0.0, 0.0, 0.0 },
+            { 0, - 1, 1, 2 },
+            { 2 },
+            std::ref(m_poincare_pos)
+        };
+    };
+
     const std::vector<Coordsys>& m_periodic_orbit_coordsys;
 
     Pcr3bp::RegBasicObjects<MapT> m_basic_objects {};
@@ -124,20 +190,7 @@ private:
         m_periodic_orbit_coordsys.at(0)
     };
 
-    CapdUtils::AffineMap<MapT> m_affine_0 { m_coordsys_0 };
-
-    LocalPoincare4_Constraint<MapT> m_extension_to_4
-    {
-        m_basic_objects.m_hamiltonian_reg2,
-        m_coordsys_0
-    };
-
-    CapdUtils::CompositeMap<MapT, MapT, decltype(m_extension_to_4)&, decltype(m_affine_0)&, MapT> m_init{ 
-        CapdUtils::ExtensionMap<MapT>::create({ 0, -1 }),
-        std::ref(m_extension_to_4),
-        std::ref(m_affine_0),
-        CapdUtils::ProjectionMap<MapT>::create(4, { 0, 2, 3 }) };
-
+    ShootingSegments m_segments { m_coordsys_0 };
 
     CapdUtils::CoordinateSection<MapT> m_v_section { 4, 1, ScalarType(0.0) };
     CapdUtils::PoincareWrapper<MapT, decltype(m_v_section)> m_poincare_pos
@@ -161,59 +214,33 @@ private:
         m_basic_objects.m_order
     };
 
-    CapdUtils::ENP<MapT, decltype(m_poincare_pos)&> m_poincare_pos_3{ 
-        { 0.0, 0.0, 0.0, 0.0 },
-        { 0, -1, 1, 2 },
-        { 0, 2, 3 },
-        std::ref(m_poincare_pos)
-    };
-
-    CapdUtils::ENP<MapT, decltype(m_poincare_pos)&> m_poincare_pos_1{ 
-        { 0.0, 0.0, 0.0, 0.0 },
-        { 0, - 1, 1, 2 },
-        { 2 },
-        std::ref(m_poincare_pos)
-    };
-
     ScalarType m_init_s {
         3.045e-9
     };
 
     CapdUtils::ParallelShootingInit<MapT, 
-        decltype(m_init)&,
-        decltype(m_poincare_pos_3)&,
-        decltype(m_poincare_pos_3)&,
-        decltype(m_poincare_pos_3)&,
-        decltype(m_poincare_pos_3)&,
-        decltype(m_poincare_pos_3)&,
-        decltype(m_poincare_pos_3)&,
-        decltype(m_poincare_pos_1)&> m_epsmr_init {
-            std::ref(m_init),
-            std::ref(m_poincare_pos_3),
-            std::ref(m_poincare_pos_3),
-            std::ref(m_poincare_pos_3),
-            std::ref(m_poincare_pos_3),
-            std::ref(m_poincare_pos_3),
-            std::ref(m_poincare_pos_3),
-            std::ref(m_poincare_pos_1) };
-
-    CapdUtils::ParallelShooting<MapT, 
-        decltype(m_init)&,
-        decltype(m_poincare_pos_3)&,
-        decltype(m_poincare_pos_3)&,
-        decltype(m_poincare_pos_3)&,
-        decltype(m_poincare_pos_3)&,
-        decltype(m_poincare_pos_3)&,
-        decltype(m_poincare_pos_3)&,
-        decltype(m_poincare_pos_1)&> m_epsmr {
-            std::ref(m_init),
-            std::ref(m_poincare_pos_3),
-            std::ref(m_poincare_pos_3),
-            std::ref(m_poincare_pos_3),
-            std::ref(m_poincare_pos_3),
-            std::ref(m_poincare_pos_3),
-            std::ref(m_poincare_pos_3),
-            std::ref(m_poincare_pos_1) };
+        decltype(m_segments.m_init)&,
+        decltype(m_segments.m_poincare_pos_3)&,
+        decltype(m_segments.m_poincare_pos_3)&,
+        decltype(m_segments.m_poincare_pos_3)&,
+        decltype(m_segments.m_poincare_pos_3)&,
+        decltype(m_segments.m_poincare_pos_3)&,
+        decltype(m_segments.m_poincare_pos_3)&,
+        decltype(m_segments.m_poincare_pos_1)&> m_epsmr_init {
+            std::ref(m_segments.m_init),
+            std::ref(m_segments.m_poincare_pos_3),
+            std::ref(m_segments.m_poincare_pos_3),
+            std::ref(m_segments.m_poincare_pos_3),
+            std::ref(m_segments.m_poincare_pos_3),
+            std::ref(m_segments.m_poincare_pos_3),
+            std::ref(m_segments.m_poincare_pos_3),
+            std::ref(m_segments.m_poincare_pos_1) };
+
+    CapdUtils::ConcurrentParallelShooting<MapT, ShootingSegments> m_epsmr {
+        [this]()
+        {
+            return std::make_unique<ShootingSegments>(m_coordsys_0);
+        } };
 
     std::vector<VectorType> m_points {};
 
@@ -9,37 +9,202 @@
 #include <pcr3bp_basic/setup_parameters.hpp>
 #include <pcr3bp_basic/standard_system.hpp>
 #include <pcr3bp_basic/regularized_system.hpp>
+#include <pcr3bp_basic/regularized_vector_field4.hpp>
+#include <pcr3bp_basic/energy_surface_reduction.hpp>
+
+#include "tools/map_clone_pool.hpp"
+#include "tools/direction.hpp"
 
 #include "periodic_orbit_parameters.hpp"
 
+#include <array>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
 namespace Pcr3bpProof
 {
 namespace Pcr3bp
 {
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Pools of clones of the regularized system maps used by RegBasicObjects
+//! @details The maps are built from the expression trees only once per map type and per parameters (mass parameter and
+//!          energy), both vector field directions are pooled. The pools are shared by reference counted pointers; every
+//!          RegBasicObjects instance leases its own clones, so the instances may be used on different threads. The energy
+//!          surface reductions are not evaluated (they only create maps per chart), so they are shared by all instances.
+//!
+//!          The registry holds weak references only: the pools of given parameters live as long as a proof context or a
+//!          RegBasicObjects instance refers to them and are released with the last reference, the expired entries are
+//!          removed from the registry on the next request.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+class RegMapPools
+{
+private:
+    using ScalarType = typename MapT::ScalarType;
+
+    // initialized before the pools, since they are built from these parameters
+    Pcr3bp::SetupParameters<MapT> m_setup;
+    ScalarType m_h0;
+
+public:
+    RegMapPools(const Pcr3bp::SetupParameters<MapT>& setup, ScalarType h0)
+        : m_setup(setup)
+        , m_h0(h0)
+    {}
+
+    RegMapPools(const RegMapPools&) = delete;
+    RegMapPools& operator=(const RegMapPools&) = delete;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Get the pools for given parameters from the registry, the pools are built on the first request
+    //! @details Parameters are compared by the bits of their bounds. The registry is locked while new pools are built, so
+    //!          concurrent requests for the same parameters build the maps only once.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static std::shared_ptr<RegMapPools> get(const Pcr3bp::SetupParameters<MapT>& setup, ScalarType h0)
+    {
+        static std::mutex s_mutex {};
+        static std::map<std::array<double, 4>, std::weak_ptr<RegMapPools>> s_registry {};
+
+        const std::pair<double, double> mu1_bounds = get_bounds(setup.get_mu(1));
+        const std::pair<double, double> h0_bounds = get_bounds(h0);
+        const std::array<double, 4> key { mu1_bounds.first, mu1_bounds.second, h0_bounds.first, h0_bounds.second };
+
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        for (auto it = s_registry.begin(); it != s_registry.end();)
+        {
+            it = it->second.expired() ? s_registry.erase(it) : std::next(it);
+        }
+
+        std::weak_ptr<RegMapPools>& entry = s_registry[key];
+
+        std::shared_ptr<RegMapPools> ret = entry.lock();
+        if (!ret)
+        {
+            ret = std::make_shared<RegMapPools>(setup, h0);
+            entry = ret;
+        }
+
+        return ret;
+    }
+
+    const Pcr3bp::SetupParameters<MapT>& get_setup() const noexcept
+    {
+        return m_setup;
+    }
+
+    ScalarType get_h0() const noexcept
+    {
+        return m_h0;
+    }
+
+    MapClonePool<MapT> m_hamiltonian_reg2 { Pcr3bp::RegularizedSystem<MapT>::createHamiltonian4(2, m_setup, m_h0) };
+    MapClonePool<MapT> m_hamiltonian_reg2_grad { Pcr3bp::RegularizedSystem<MapT>::createHamiltonianGradient4(2, m_setup, m_h0) };
+
+    MapClonePool<Pcr3bp::RegularizedVectorField4<MapT>> m_vf_reg_pos2 { { 2, m_setup, ScalarType(+1.0), m_h0 } };
+    MapClonePool<Pcr3bp::RegularizedVectorField4<MapT>> m_vf_reg_neg2 { { 2, m_setup, ScalarType(-1.0), m_h0 } };
+
+    MapClonePool<MapT> m_collision_condition { Pcr3bp::RegularizedSystem<MapT>::createCollisionCondition(2, m_setup) };
+
+    const Pcr3bp::EnergySurfaceReduction<MapT> m_energy_surface_pos2 { 2, m_setup, ScalarType(+1.0), m_h0 };
+    const Pcr3bp::EnergySurfaceReduction<MapT> m_energy_surface_neg2 { 2, m_setup, ScalarType(-1.0), m_h0 };
+
+private:
+    static std::pair<double, double> get_bounds(const ScalarType& x)
+    {
+        if constexpr (std::is_arithmetic_v<ScalarType>)
+        {
+            return { x, x };
+        }
+        else
+        {
+            return { x.leftBound(), x.rightBound() };
+        }
+    }
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //! @brief A container for the basic PCR3BP objects necessary for the computer-assisted proof
+//! @details The maps are clones leased from the RegMapPools of the setup parameters and returned to the pools on
+//!          destruction, so the expression trees are not rebuilt by every instance. Instances of a proof context are created
+//!          from the pools of the context (see ProofContext), the default instance uses the default mass parameter and the
+//!          energy of RegLyapunovCollisionOrbitParameters.
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename MapT>
 class RegBasicObjects
 {
+private:
+    using Lease = typename MapClonePool<MapT>::Lease;
+    using VectorFieldLease = typename MapClonePool<Pcr3bp::RegularizedVectorField4<MapT>>::Lease;
+
+    std::shared_ptr<RegMapPools<MapT>> m_pools;
+
+    Lease m_hamiltonian_reg2_lease { m_pools->m_hamiltonian_reg2.acquire() };
+    Lease m_hamiltonian_reg2_grad_lease { m_pools->m_hamiltonian_reg2_grad.acquire() };
+    VectorFieldLease m_vf_reg_pos2_lease { m_pools->m_vf_reg_pos2.acquire() };
+    VectorFieldLease m_vf_reg_neg2_lease { m_pools->m_vf_reg_neg2.acquire() };
+    Lease m_collision_condition_lease { m_pools->m_collision_condition.acquire() };
+
 public:
     using ScalarType = typename MapT::ScalarType;
     using VectorType = typename MapT::VectorType;
     using MatrixType = typename MapT::MatrixType;
 
-    Pcr3bp::SetupParameters<MapT> m_setup {};
+    //! vector field with hand-coded Taylor coefficients, derived from MapT
+    using VectorFieldT = Pcr3bp::RegularizedVectorField4<MapT>;
+
+    RegBasicObjects() : RegBasicObjects(Pcr3bp::SetupParameters<MapT>())
+    {}
+
+    explicit RegBasicObjects(const Pcr3bp::SetupParameters<MapT>& setup)
+        : RegBasicObjects(setup, RegLyapunovCollisionOrbitParameters<MapT>{ setup }.get_energy())
+    {}
+
+    RegBasicObjects(const Pcr3bp::SetupParameters<MapT>& setup, ScalarType h0)
+        : RegBasicObjects(RegMapPools<MapT>::get(setup, h0))
+    {}
+
+    explicit RegBasicObjects(std::shared_ptr<RegMapPools<MapT>> pools)
+        : m_pools(std::move(pools))
+        , m_setup(m_pools->get_setup())
+        , m_h0(m_pools->get_h0())
+    {}
+
+    RegBasicObjects(const RegBasicObjects&) = delete;
+    RegBasicObjects& operator=(const RegBasicObjects&) = delete;
+
+    //! pools the maps are leased from, further instances with the same parameters are created from them
+    const std::shared_ptr<RegMapPools<MapT>>& get_pools() const noexcept
+    {
+        return m_pools;
+    }
+
+    Pcr3bp::SetupParameters<MapT> m_setup;
     RegLyapunovCollisionOrbitParameters<MapT> m_parameters { m_setup };
 
-    ScalarType m_h0 { m_parameters.get_energy() };
+    ScalarType m_h0;
+
+    MapT& m_hamiltonian_reg2 { *m_hamiltonian_reg2_lease };
+    MapT& m_hamiltonian_reg2_grad { *m_hamiltonian_reg2_grad_lease };
 
-    MapT m_hamiltonian_reg2 { Pcr3bp::RegularizedSystem<MapT>::createHamiltonian4(2, m_setup, m_h0) };
-    MapT m_hamiltonian_reg2_grad { Pcr3bp::RegularizedSystem<MapT>::createHamiltonianGradient4(2, m_setup, m_h0) };
+    VectorFieldT& m_vf_reg_pos2 { *m_vf_reg_pos2_lease };
+    VectorFieldT& m_vf_reg_neg2 { *m_vf_reg_neg2_lease };
 
-    MapT m_vf_reg_pos2 { Pcr3bp::RegularizedSystem<MapT>::createPositiveVectorField4(2, m_setup, m_h0) };
-    MapT m_vf_reg_neg2 { Pcr3bp::RegularizedSystem<MapT>::createNegativeVectorField4(2, m_setup, m_h0) };
+    MapT& m_collision_condition { *m_collision_condition_lease };
 
-    MapT m_collision_condition { Pcr3bp::RegularizedSystem<MapT>::createCollisionCondition(2, m_setup) };
+    //! reductions of m_vf_reg_pos2 and m_vf_reg_neg2 to the energy surface, the maps are created per chart
+    const Pcr3bp::EnergySurfaceReduction<MapT>& m_energy_surface_pos2 { m_pools->m_energy_surface_pos2 };
+    const Pcr3bp::EnergySurfaceReduction<MapT>& m_energy_surface_neg2 { m_pools->m_energy_surface_neg2 };
+
+    const Pcr3bp::EnergySurfaceReduction<MapT>& get_energy_surface_reduction(Direction direction) const noexcept
+    {
+        return direction == Direction::Positive ? m_energy_surface_pos2 : m_energy_surface_neg2;
+    }
 
     unsigned m_order { 60 };
 
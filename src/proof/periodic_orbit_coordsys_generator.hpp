@@ -17,16 +17,22 @@
 #include <capd_utils/parallel_shooting/parallel_shooting_init.hpp>
 
 #include "tools/affine_poincare_map.hpp"
+#include "tools/memoized_poincare_map.hpp"
 #include "tools/coordsys4_alignment.hpp"
 #include "tools/power_iteration.hpp"
 #include "tools/auxiliary_functions.hpp"
 
+#include <iostream>
+#include <sstream>
+
 namespace Pcr3bpProof
 {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //! @brief Compute coordinate systems in the fixed point and in 3 other points that are approximately located on
 //!        the collision/ejection orbit.
+//! @details The segments of the Poincare map around the orbit are memoized, so the derivatives of the first two segments
+//!          are taken from the evaluation of the whole map at the points it visits, without another integration.
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename MapT>
 class PeriodicOrbitCoordsysGenerator
@@ -40,9 +46,14 @@ public:
 
     static_assert(std::is_same<MapT, RMap>::value);
 
-    PeriodicOrbitCoordsysGenerator()
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //!
+    //! @param pools maps of the setup parameters (see ProofContext)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    explicit PeriodicOrbitCoordsysGenerator(std::shared_ptr<Pcr3bp::RegMapPools<MapT>> pools)
+        : m_basic_objects(std::move(pools))
     {
-        std::cout.precision(15);
         {
             CapdUtils::AffinePoincareMap poincare_1_pos
             {
@@ -92,14 +103,17 @@ public:
                 m_initial_coordsys.at(0)
             };
             
+            CapdUtils::MemoizedPoincareMap<MapT> poincare_1_pos_memoized { poincare_1_pos };
+            CapdUtils::MemoizedPoincareMap<MapT> poincare_2_pos_memoized { poincare_2_pos };
+
             CapdUtils::CompositeMap<MapT,
-                CapdUtils::AffinePoincareMap<MapT>&,
-                CapdUtils::AffinePoincareMap<MapT>&,
+                CapdUtils::MemoizedPoincareMap<MapT>&,
+                CapdUtils::MemoizedPoincareMap<MapT>&,
                 CapdUtils::AffinePoincareMap<MapT>&,
                 CapdUtils::AffinePoincareMap<MapT>&> poincare_total
             {
-                std::ref(poincare_1_pos),
-                std::ref(poincare_2_pos),
+                std::ref(poincare_1_pos_memoized),
+                std::ref(poincare_2_pos_memoized),
                 std::ref(poincare_3_pos),
                 std::ref(poincare_0_pos)
             };
@@ -111,7 +125,7 @@ public:
                 const ScalarType epsilon = norm( poincare_total( VectorType(4), der ) );
                 if (epsilon > 1.4e-12)
                 {
-                    std::cout << "WARNING at line " << __LINE__ << ": Result norm exceeds threshold! (epsilon = " << epsilon << ")";
+                    print_warning(__LINE__, epsilon);
                 }
             }
 
@@ -122,23 +136,26 @@ public:
             const VectorType stable_dir_w0 = AuxiliaryFunctions<MapT>::S_symmetry(unstable_dir_w0);
 
             MatrixType der1 {};
+            const VectorType w1_local = poincare_1_pos_memoized(VectorType(4), der1);
             {
-                const ScalarType epsilon = norm( poincare_1_pos(VectorType(4), der1) );
+                const ScalarType epsilon = norm( w1_local );
                 if (epsilon > 2.9e-15)
                 {
-                    std::cout << "WARNING at line " << __LINE__ << ": Result norm exceeds threshold! (epsilon = " << epsilon << ")\n";
+                    print_warning(__LINE__, epsilon);
                 }
             }
 
             const VectorType unstable_dir_w1_local = (der1 * unstable_dir_w0_local) / expansion_factor;
             const VectorType unstable_dir_w1 = m_initial_coordsys.at(1).get_directions_matrix() * unstable_dir_w1_local;
 
+            // the second segment is evaluated at the image of the first one (as in poincare_total), the offset of the image
+            // from the origin is propagated by its derivative
             MatrixType der2 {};
             {
-                const ScalarType epsilon = norm( poincare_2_pos(VectorType(4), der2) );
-                if (epsilon > 1.2e-16)
+                const ScalarType epsilon = norm( poincare_2_pos_memoized(w1_local, der2) );
+                if (epsilon > 1.2e-16 + norm(der2 * w1_local))
                 {
-                    std::cout << "WARNING at line " << __LINE__ << ": Result norm exceeds threshold! (epsilon = " << epsilon << ")\n";
+                    print_warning(__LINE__, epsilon);
                 }
             }
 
@@ -157,13 +174,16 @@ public:
                 const ScalarType epsilon = norm( poincare_1_neg(VectorType(4), der1_neg) );
                 if (epsilon > 7.2e-14)
                 {
-                    std::cout << "WARNING at line " << __LINE__ << ": Result norm exceeds threshold! (epsilon = " << epsilon << ")\n";
+                    print_warning(__LINE__, epsilon);
                 }
             }
 
             const VectorType stable_dir_w1_local = (der1_neg * stable_dir_w2_local) / expansion_factor;
             const VectorType stable_dir_w1 = m_initial_coordsys.at(1).get_directions_matrix() * stable_dir_w1_local;
 
+            assert_with_exception(poincare_1_pos_memoized.get_evaluation_count() == 1);
+            assert_with_exception(poincare_2_pos_memoized.get_evaluation_count() == 1);
+
             m_local_coord.reserve(4);
             m_local_coord.push_back(
                 Coordsys4_Alignment<MapT>::replace_unstable_dirs_and_make_S_backsymmetric(
@@ -193,8 +213,16 @@ public:
     }
 
 private:
-    Pcr3bp::RegBasicObjects<MapT> m_basic_objects {};
-    RegLyapunovCollisionOrbitParameters<MapT> m_parameters {};
+    //! the generator may run concurrently with other stages (see FullProofTaskGraph), so the format of std::cout is not changed
+    static void print_warning(int line, ScalarType epsilon)
+    {
+        std::stringstream warning {};
+        warning.precision(15);
+        warning << "WARNING at line " << line << ": Result norm exceeds threshold! (epsilon = " << epsilon << ")\n";
+        std::cout << warning.str();
+    }
+
+    Pcr3bp::RegBasicObjects<MapT> m_basic_objects;
 
     std::array<Coordsys, 4> m_initial_coordsys
     {
@@ -21,8 +21,14 @@
 #include <capd_utils/parallel_shooting/parallel_shooting.hpp>
 #include <capd_utils/parallel_shooting/parallel_shooting_init.hpp>
 
+#include "tools/concurrent_parallel_shooting.hpp"
+
 #include "pcr3bp_reg_basic_objects.hpp"
 
+#include <iostream>
+#include <memory>
+#include <tuple>
+
 namespace Pcr3bpProof
 {
 
@@ -34,10 +40,16 @@ public:
     using VectorType = typename MapT::VectorType;
     using MatrixType = typename MapT::MatrixType;
 
-    LyapunovOrbitRegCollisionSetup(ScalarType intermediate_time, bool full_test = true) : m_intermediate_time(intermediate_time)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Compute the Lyapunov orbit with parallel shooting and check it against RegLyapunovCollisionOrbitParameters
+    //!
+    //! @param log stream of the log, its precision is set to 15 digits
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    LyapunovOrbitRegCollisionSetup(ScalarType intermediate_time, bool full_test = true, std::ostream& log = std::cout)
+        : m_intermediate_time(intermediate_time)
     {
-        std::cout.precision(15);
-        print_var(intermediate_time);
+        log.precision(15);
+        print_var_to(log, intermediate_time);
 
         const VectorType h0 = VectorType{ -0.711059 };
         const VectorType v = m_parallel_shooting_init(h0);
@@ -49,7 +61,7 @@ public:
         const VectorType root = newton.get_root();
 
         const VectorType intermediate_point = { root[0], root[1], root[2], root[3] };
-        VectorType image_point = CapdUtils::Extract<MapT>::get_vector(m_poincare(root), 0, 4);
+        VectorType image_point = CapdUtils::Extract<MapT>::get_vector(m_segments.m_poincare(root), 0, 4);
 
         image_point[1] = 0.0; // v-component is 0.0 from the definition of the poincare section
         image_point[2] = 0.0; // pu-component is 0.0 from the Newton operator definition
@@ -71,47 +83,69 @@ public:
                     << m_basic_objects.m_parameters.get_energy();
             }
 
-            const ScalarType lyapunov_orbit_period_diff = capd::abs( (intermediate_time + m_poincare.get_last_evaluation_return_time())*2 - m_basic_objects.m_lyapunov_orbit_period );
+            const ScalarType lyapunov_orbit_period_diff = capd::abs( (intermediate_time + m_segments.m_poincare.get_last_evaluation_return_time())*2 - m_basic_objects.m_lyapunov_orbit_period );
             EXPECT_LT(lyapunov_orbit_period_diff, 1.3e-13);
         }
     }
 
 private:
-    Pcr3bp::RegBasicObjects<MapT> m_basic_objects {};
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Maps of the parallel shooting segments, every worker thread evaluates its own instance
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct ShootingSegments
+    {
+        explicit ShootingSegments(ScalarType intermediate_time) : m_intermediate_time(intermediate_time)
+        {}
 
-    ScalarType const m_intermediate_time;
-    MapT m_vf_reg { Pcr3bp::RegularizedSystem<MapT>::createPositiveVectorField(2, m_basic_objects.m_setup, false) };
+        auto get_segments()
+        {
+            return std::tie(m_timemap_1_to_5, m_poincare_5_to_1);
+        }
 
-    CapdUtils::CoordinateSection<MapT> m_section { m_vf_reg.dimension(), 1, 0 };
-    CapdUtils::PoincareWrapper<MapT, decltype(m_section)> m_poincare { m_vf_reg, m_basic_objects.m_order, m_section };
-    CapdUtils::TimemapWrapper<MapT> m_timemap { m_vf_reg, m_intermediate_time, m_basic_objects.m_order };
+        Pcr3bp::RegBasicObjects<MapT> m_basic_objects {};
 
-    const VectorType m_initial_point { m_basic_objects.m_parameters.get_initial_point() };
-    const VectorType m_h_to_5_extend_vector { CapdUtils::Concat<MapT>::concat_vectors({ m_initial_point, VectorType{ 0.0 } }) };
-    MapT m_h_to_5_extend { CapdUtils::ExtensionMap<MapT>::create(m_h_to_5_extend_vector, { -1, -1, -1, -1, 0 }) };
-    CapdUtils::CompositeMap<MapT, MapT, decltype(m_timemap)&> m_timemap_1_to_5
-    {
-        m_h_to_5_extend,
-        std::ref(m_timemap)
-    };
+        ScalarType const m_intermediate_time;
+        MapT m_vf_reg { Pcr3bp::RegularizedSystem<MapT>::createPositiveVectorField(2, m_basic_objects.m_setup, false) };
 
-    MapT m_5_to_pu_projection { CapdUtils::ProjectionMap<MapT>::create(5, { 2 }) };
-    CapdUtils::CompositeMap<MapT, decltype(m_poincare)&, MapT> m_poincare_5_to_1
-    {
-        std::ref(m_poincare),
-        m_5_to_pu_projection
+        CapdUtils::CoordinateSection<MapT> m_section { m_vf_reg.dimension(), 1, 0 };
+        CapdUtils::PoincareWrapper<MapT, decltype(m_section)> m_poincare { m_vf_reg, m_basic_objects.m_order, m_section };
+        CapdUtils::TimemapWrapper<MapT> m_timemap { m_vf_reg, m_intermediate_time, m_basic_objects.m_order };
+
+        const VectorType m_initial_point { m_basic_objects.m_parameters.get_initial_point() };
+        const VectorType m_h_to_5_extend_vector { CapdUtils::Concat<MapT>::concat_vectors({ m_initial_point, VectorType{ 0.0 } }) };
+        MapT m_h_to_5_extend { CapdUtils::ExtensionMap<MapT>::create(m_h_to_5_extend_vector, { -1, -1, -1, -1, 0 }) };
+        CapdUtils::CompositeMap<MapT, MapT, decltype(m_timemap)&> m_timemap_1_to_5
+        {
+            m_h_to_5_extend,
+            std::ref(m_timemap)
+        };
+
+        MapT m_5_to_pu_projection { CapdUtils::ProjectionMap<MapT>::create(5, { 2 }) };
+        CapdUtils::CompositeMap<MapT, decltype(m_poincare)&, MapT> m_poincare_5_to_1
+        {
+            std::ref(m_poincare),
+            m_5_to_pu_projection
+        };
     };
 
-    CapdUtils::ParallelShootingInit<MapT, decltype(m_timemap_1_to_5)&, decltype(m_poincare_5_to_1)&> m_parallel_shooting_init
+    Pcr3bp::RegBasicObjects<MapT> m_basic_objects {};
+
+    ScalarType const m_intermediate_time;
+
+    ShootingSegments m_segments { m_intermediate_time };
+
+    CapdUtils::ParallelShootingInit<MapT, decltype(m_segments.m_timemap_1_to_5)&, decltype(m_segments.m_poincare_5_to_1)&> m_parallel_shooting_init
     {
-        std::ref(m_timemap_1_to_5),
-        std::ref(m_poincare_5_to_1)
+        std::ref(m_segments.m_timemap_1_to_5),
+        std::ref(m_segments.m_poincare_5_to_1)
     };
 
-    CapdUtils::ParallelShooting<MapT, decltype(m_timemap_1_to_5)&, decltype(m_poincare_5_to_1)&> m_parallel_shooting
+    CapdUtils::ConcurrentParallelShooting<MapT, ShootingSegments> m_parallel_shooting
     {
-        std::ref(m_timemap_1_to_5),
-        std::ref(m_poincare_5_to_1)
+        [this]()
+        {
+            return std::make_unique<ShootingSegments>(m_intermediate_time);
+        }
     };
 
     CapdUtils::ENP<MapT, decltype(m_parallel_shooting)&> m_parallel_shooting_optimized
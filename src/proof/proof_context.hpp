@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "tools/psi0_coefficients.hpp"
+
+#include "covering_relations_setup.hpp"
+#include "pcr3bp_reg_basic_objects.hpp"
+
+#include <memory>
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief State shared by all verification stages of a single proof: the parameters of the problem (mass parameter and
+//!        energy), the covering relations setup (coordsys along the periodic and the homoclinic orbit), the pools of the
+//!        maps and the psi0 coefficients
+//! @details The setup is generated in double precision, so it is given its own approximations of the parameters. The maps
+//!          of both precisions are taken from the RegMapPools of the parameters, every stage leases its own basic objects
+//!          from the pools of the context (see create_basic_objects), so the stages do not share any maps.
+//!
+//!          The psi0 coefficients are created in the constructor, so their cost is paid up front and not on the first
+//!          covering check with specialized psi0 coordinates. The setup stages are computed in the constructor in sequential
+//!          mode, or when requested in pipelined mode (see CoveringRelationsSetup).
+//!
+//!          The internal map of the psi0 coefficients is evaluated by the specialized psi0 constraints, hence stages of the
+//!          same context using specialized coordinates must not run concurrently. Different contexts do not share any state
+//!          (contexts with equal parameters share the map pools, which are thread-safe), so they may be verified concurrently.
+//!
+//!          The orbit constants of RegLyapunovCollisionOrbitParameters are available for the default mass parameter only.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+class ProofContext
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+
+    //! Context with the default mass parameter and the energy of RegLyapunovCollisionOrbitParameters
+    explicit ProofContext(CoveringRelationsSetup::Mode mode = CoveringRelationsSetup::Mode::Sequential)
+        : ProofContext(
+            Pcr3bp::SetupParameters<MapT>(),
+            RegLyapunovCollisionOrbitParameters<MapT>().get_energy(),
+            Pcr3bp::SetupParameters<RMap>(),
+            RegLyapunovCollisionOrbitParameters<RMap>().get_energy(),
+            mode)
+    {}
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //!
+    //! @param setup mass parameter of the verification stages
+    //! @param h0 energy of the verification stages
+    //! @param setup_approx mass parameter of the covering relations setup (approximation of setup)
+    //! @param h0_approx energy of the covering relations setup (approximation of h0)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ProofContext(
+        const Pcr3bp::SetupParameters<MapT>& setup,
+        ScalarType h0,
+        const Pcr3bp::SetupParameters<RMap>& setup_approx,
+        Real h0_approx,
+        CoveringRelationsSetup::Mode mode = CoveringRelationsSetup::Mode::Sequential)
+            : m_pools(Pcr3bp::RegMapPools<MapT>::get(setup, h0))
+            , m_setup(Pcr3bp::RegMapPools<RMap>::get(setup_approx, h0_approx), mode)
+    {}
+
+    ProofContext(const ProofContext&) = delete;
+    ProofContext& operator=(const ProofContext&) = delete;
+
+    const CoveringRelationsSetup& get_setup() const noexcept
+    {
+        return m_setup;
+    }
+
+    const std::shared_ptr<Pcr3bp::RegMapPools<MapT>>& get_pools() const noexcept
+    {
+        return m_pools;
+    }
+
+    //! basic objects with the parameters of the context and their own maps, for a single stage or worker thread
+    std::unique_ptr<Pcr3bp::RegBasicObjects<MapT>> create_basic_objects() const
+    {
+        return std::make_unique<Pcr3bp::RegBasicObjects<MapT>>(m_pools);
+    }
+
+    Psi0_Coefficients<MapT>& get_psi0_coefficients() noexcept
+    {
+        return m_psi0_coefficients;
+    }
+
+private:
+    std::shared_ptr<Pcr3bp::RegMapPools<MapT>> m_pools;
+
+    CoveringRelationsSetup m_setup;
+
+    Psi0_Coefficients<MapT> m_psi0_coefficients { m_pools->get_setup(), m_pools->get_h0() };
+};
+
+}
@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "tools/test_tools.hpp"
+
+#include "pcr3bp_reg_basic_objects.hpp"
+
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Consistency check of the hand-coded Taylor coefficients of the regularized vector field with the coefficients
+//!        computed by CAPD from the expression tree of the same vector field
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_regularized_vector_field, taylor_coefficients)
+{
+    using namespace Pcr3bpProof;
+
+    capd::rounding::DoubleRounding::roundNearest();
+
+    using ScalarType = IMap::ScalarType;
+    using size_type = IMatrix::size_type;
+
+    const Pcr3bp::SetupParameters<IMap> setup {};
+    const ScalarType h0 = Pcr3bp::RegBasicObjects<IMap>{}.m_h0;
+
+    const size_type order = 20;
+
+    for (const ScalarType direction : { ScalarType(+1.0), ScalarType(-1.0) })
+    {
+        Pcr3bp::RegularizedVectorField4<IMap> vector_field { 2, setup, direction, h0 };
+
+        IMap reference = direction > 0.0 ?
+            Pcr3bp::RegularizedSystem<IMap>::createPositiveVectorField4(2, setup, h0) :
+            Pcr3bp::RegularizedSystem<IMap>::createNegativeVectorField4(2, setup, h0);
+        reference.setOrder(order + 1);
+
+        std::vector<IVector> coeffs(order + 1, IVector(4));
+        std::vector<IMatrix> dcoeffs(order + 1, IMatrix(4, 4));
+        std::vector<IVector> reference_coeffs(order + 1, IVector(4));
+        std::vector<IMatrix> reference_dcoeffs(order + 1, IMatrix(4, 4));
+
+        const IVector x0 { ScalarType(0.3, 0.3 + 1e-10), ScalarType(0.2), ScalarType(0.5), ScalarType(-0.4) };
+
+        coeffs.front() = x0;
+        reference_coeffs.front() = x0;
+        dcoeffs.front() = IMatrix::Identity(4);
+        reference_dcoeffs.front() = IMatrix::Identity(4);
+
+        vector_field.computeODECoefficients(coeffs.data(), dcoeffs.data(), order);
+        reference.computeODECoefficients(reference_coeffs.data(), reference_dcoeffs.data(), order);
+
+        for (size_type k = 0; k <= order; ++k)
+        {
+            IVector coeffs_intersection(4);
+            EXPECT_TRUE( intersection(coeffs.at(k), reference_coeffs.at(k), coeffs_intersection) );
+
+            IMatrix dcoeffs_intersection(4, 4);
+            EXPECT_TRUE( intersection(dcoeffs.at(k), reference_dcoeffs.at(k), dcoeffs_intersection) );
+        }
+    }
+}
@@ -6,6 +6,9 @@
 
 #include "tools/local_poincare4.hpp"
 #include "tools/gain_map.hpp"
+#include "tools/direction.hpp"
+
+#include "pcr3bp_reg_basic_objects.hpp"
 
 namespace Pcr3bpProof
 {
@@ -21,15 +24,19 @@ public:
     using VectorType = typename MapT::VectorType;
     using MatrixType = typename MapT::MatrixType;
 
+    template<typename VectorFieldT>
     ScaledLocalPoincare4_Map(
-        MapT& vector_field,
+        VectorFieldT& vector_field,
         MapT& constraint,
         unsigned order,
         const CapdUtils::LocalCoordinateSystem<MapT>& src_coordsys,
         const CapdUtils::LocalCoordinateSystem<MapT>& dst_coordsys,
         ScalarType input_gain,
         bool src_specialized,
-        bool dst_specialized)
+        bool dst_specialized,
+        Psi0_Coefficients<MapT>* psi0_coefficients = nullptr,
+        const Pcr3bp::EnergySurfaceReduction<MapT>* energy_surface_reduction = nullptr,
+        const CapdUtils::StepSchedule* step_schedule = nullptr)
             : m_local_poincare4(
                 vector_field,
                 constraint,
@@ -37,7 +44,10 @@ public:
                 src_coordsys,
                 dst_coordsys,
                 src_specialized,
-                dst_specialized)
+                dst_specialized,
+                psi0_coefficients,
+                energy_surface_reduction,
+                step_schedule)
             , m_input_gain(input_gain, m_local_poincare4.dimension())
             , m_output_gain(ScalarType(1.0) / input_gain, m_local_poincare4.imageDimension())
     {}
@@ -47,9 +57,19 @@ public:
         return m_composite(vec);
     }
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Value and derivative
+    //! @details The gains are scalar, so the derivative of the local Poincare map is scaled in place instead of composing
+    //!          it with the diagonal derivatives of the gain maps.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     VectorType operator() (const VectorType& vec, MatrixType& der) override
     {
-        return m_composite(vec, der);
+        const ScalarType input_gain = m_input_gain.get_gain();
+        const ScalarType output_gain = m_output_gain.get_gain();
+
+        const VectorType ret = m_local_poincare4(vec * input_gain, der) * output_gain;
+        der *= (output_gain * input_gain);
+        return ret;
     }
 
     unsigned dimension() const override
@@ -67,6 +87,11 @@ public:
         return m_local_poincare4.get_last_evaluation_return_time();
     }
 
+    bool is_energy_surface_reduced() const noexcept
+    {
+        return m_local_poincare4.is_energy_surface_reduced();
+    }
+
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //! @brief Get Poincare time and solution curve of the underlying Poincare map
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -93,4 +118,79 @@ private:
     };
 };
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Scaled local Poincare map that owns the basic objects it evaluates
+//! @details The basic objects are leased from the given pools (see ProofContext). Several instances of this component can be
+//!          evaluated concurrently, since they do not share any maps, unless the source coordsys is specialized (the
+//!          instances share the psi0 map of the proof context). If energy_surface_reduction is set, the Poincare map is
+//!          computed with the vector field reduced to the energy surface (where a chart adapted to the destination section
+//!          exists). If step_schedule is set, the Poincare map replays its time steps (see StepReplayPoincareMap), the
+//!          schedule is only read, so it may be shared by the instances.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+class ScaledLocalPoincare4_MapInstance : public CapdUtils::MapBase<MapT>
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+    using VectorType = typename MapT::VectorType;
+    using MatrixType = typename MapT::MatrixType;
+
+    ScaledLocalPoincare4_MapInstance(
+        std::shared_ptr<Pcr3bp::RegMapPools<MapT>> pools,
+        Direction direction,
+        unsigned order,
+        const CapdUtils::LocalCoordinateSystem<MapT>& src_coordsys,
+        const CapdUtils::LocalCoordinateSystem<MapT>& dst_coordsys,
+        ScalarType input_gain,
+        bool src_specialized,
+        bool dst_specialized,
+        Psi0_Coefficients<MapT>* psi0_coefficients = nullptr,
+        bool energy_surface_reduction = false,
+        const CapdUtils::StepSchedule* step_schedule = nullptr)
+            : m_basic_objects(std::move(pools))
+            , m_map(
+                direction == Direction::Positive ? m_basic_objects.m_vf_reg_pos2 : m_basic_objects.m_vf_reg_neg2,
+                m_basic_objects.m_hamiltonian_reg2,
+                order,
+                src_coordsys,
+                dst_coordsys,
+                input_gain,
+                src_specialized,
+                dst_specialized,
+                psi0_coefficients,
+                energy_surface_reduction ? &m_basic_objects.get_energy_surface_reduction(direction) : nullptr,
+                step_schedule)
+    {}
+
+    VectorType operator() (const VectorType& vec) override
+    {
+        return m_map(vec);
+    }
+
+    VectorType operator() (const VectorType& vec, MatrixType& der) override
+    {
+        return m_map(vec, der);
+    }
+
+    unsigned dimension() const override
+    {
+        return m_map.dimension();
+    }
+
+    unsigned imageDimension() const override
+    {
+        return m_map.imageDimension();
+    }
+
+    ScalarType get_last_evaluation_return_time() const
+    {
+        return m_map.get_last_evaluation_return_time();
+    }
+
+private:
+    Pcr3bp::RegBasicObjects<MapT> m_basic_objects;
+
+    ScaledLocalPoincare4_Map<MapT> m_map;
+};
+
 }
@@ -0,0 +1,45 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "sharded_proof_test.hpp"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Part of interval arithmetic validation of Theorem 8, Lemma 8, Lemma 10 and Lemma 11 assigned to a single shard
+//!
+//!        The shard is selected with PCR3BP_SHARD_INDEX and PCR3BP_SHARD_COUNT environment variables, the results are
+//!        written to PCR3BP_SHARD_RESULT_DIR. The test is skipped if PCR3BP_SHARD_COUNT is not set (see run_sharded.sh).
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_sharded_proof, shard)
+{
+    using namespace Pcr3bpProof;
+
+    ShardSpec spec {};
+    if (!ShardSpec::from_environment(spec))
+    {
+        GTEST_SKIP() << "PCR3BP_SHARD_COUNT not set";
+    }
+
+    capd::rounding::DoubleRounding::roundNearest();
+
+    ProofContext<IMap> context {};
+    ShardedProofRunner runner { context };
+    runner.run(spec).write(spec.get_result_path());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Merge results of all shards, the test passes only if every covering relation check passed in some shard
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_sharded_proof, merge)
+{
+    using namespace Pcr3bpProof;
+
+    ShardSpec spec {};
+    if (!ShardSpec::from_environment(spec))
+    {
+        GTEST_SKIP() << "PCR3BP_SHARD_COUNT not set";
+    }
+
+    ShardReportMerger merger { spec };
+    merger.report();
+}
@@ -0,0 +1,496 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "tools/test_tools.hpp"
+
+#include "covering_relations_test.hpp"
+#include "covering_relations_test.parallelogram_covering_derivative_check.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Specification of a shard (shard index out of shard count) and of the directory with the shard result files
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ShardSpec
+{
+    size_t index { 0 };
+    size_t count { 1 };
+    std::string result_dir { "." };
+
+    bool owns(size_t job_idx) const noexcept
+    {
+        return job_idx % count == index;
+    }
+
+    std::string get_result_path() const
+    {
+        return get_result_path(index);
+    }
+
+    std::string get_result_path(size_t shard_idx) const
+    {
+        return result_dir + "/shard_" + std::to_string(shard_idx) + "_of_" + std::to_string(count) + ".tsv";
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Read PCR3BP_SHARD_INDEX, PCR3BP_SHARD_COUNT and PCR3BP_SHARD_RESULT_DIR environment variables
+    //! @return False if PCR3BP_SHARD_COUNT is not set (sharded execution disabled)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static bool from_environment(ShardSpec& spec)
+    {
+        const char* count_env = std::getenv("PCR3BP_SHARD_COUNT");
+        if (!count_env)
+        {
+            return false;
+        }
+
+        spec = ShardSpec {};
+        spec.count = std::strtoul(count_env, nullptr, 10);
+
+        if (const char* index_env = std::getenv("PCR3BP_SHARD_INDEX"))
+        {
+            spec.index = std::strtoul(index_env, nullptr, 10);
+        }
+
+        if (const char* dir_env = std::getenv("PCR3BP_SHARD_RESULT_DIR"))
+        {
+            spec.result_dir = dir_env;
+        }
+
+        if (spec.count == 0 || spec.index >= spec.count)
+        {
+            throw std::logic_error("Invalid shard specification!");
+        }
+
+        return true;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Outcome of a single job of the sharded execution
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ShardJobResult
+{
+    size_t job_idx { 0 };
+    std::string name {};
+    bool passed { false };
+    long long duration_ms { 0 };
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Results of a single shard
+//! @details Stored as a tab separated text file:
+//!
+//!          shard <index> <count>
+//!          job_count <total number of jobs of all shards>
+//!          job <job index> <passed (0 or 1)> <duration in ms> <name>
+//!          ...
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ShardResults
+{
+    size_t shard_idx { 0 };
+    size_t shard_count { 1 };
+    size_t job_count { 0 };
+    std::vector<ShardJobResult> jobs {};
+
+    void write(const std::string& path) const
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error("Unable to write shard result file " + path);
+        }
+
+        file << "shard\t" << shard_idx << '\t' << shard_count << '\n';
+        file << "job_count\t" << job_count << '\n';
+
+        for (const ShardJobResult& job : jobs)
+        {
+            file << "job\t" << job.job_idx << '\t' << (job.passed ? 1 : 0) << '\t' << job.duration_ms << '\t' << job.name << '\n';
+        }
+    }
+
+    static ShardResults read(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error("Unable to read shard result file " + path);
+        }
+
+        ShardResults ret {};
+
+        std::string line {};
+        while (std::getline(file, line))
+        {
+            std::istringstream line_stream(line);
+
+            std::string key {};
+            std::getline(line_stream, key, '\t');
+
+            if (key == "shard")
+            {
+                line_stream >> ret.shard_idx >> ret.shard_count;
+            }
+            else if (key == "job_count")
+            {
+                line_stream >> ret.job_count;
+            }
+            else if (key == "job")
+            {
+                ShardJobResult job {};
+                int passed = 0;
+                line_stream >> job.job_idx >> passed >> job.duration_ms;
+                line_stream.ignore(1);
+                std::getline(line_stream, job.name);
+
+                job.passed = (passed == 1);
+                ret.jobs.push_back(job);
+            }
+
+            if (line_stream.fail())
+            {
+                throw std::runtime_error("Malformed shard result file " + path + ": " + line);
+            }
+        }
+
+        return ret;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Run the part of the covering relation checks assigned to a shard
+//! @details The full list of jobs (homoclinic pairs, periodic pairs, jump covering and parallelogram checks) is the same in
+//!          every process, the jobs are assigned to the shards in round robin order. A job passes if it does not produce
+//!          any gtest failure (nor exception).
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ShardedProofRunner
+{
+public:
+    using MapT = IMap;
+
+    explicit ShardedProofRunner(ProofContext<MapT>& context) : m_context(context)
+    {
+        // orders are calibrated once beforehand, the shards only read them
+        const std::string taylor_order_path = TaylorOrderTable::get_path_from_environment();
+        if (!taylor_order_path.empty())
+        {
+            m_coverings_test.set_taylor_orders(TaylorOrderTable::read(taylor_order_path));
+        }
+
+        const size_t pair_count = m_context.get_setup().get_homoclinic_orbit_coordsys().size() - 1;
+        for (size_t i = 0; i < pair_count; ++i)
+        {
+            add_job("homoclinic orbit covering " + std::to_string(i) + " => " + std::to_string(i + 1), [this, i]()
+            {
+                Pcr3bp::RegBasicObjects<MapT> basic_objects { m_context.get_pools() };
+                m_coverings_test.check_homoclinic_covering(basic_objects, i, m_coverings_test_worker_count).report();
+            });
+        }
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            add_job("periodic orbit covering " + std::to_string(i) + " => " + std::to_string(i + 1), [this, i]()
+            {
+                m_coverings_test.check_periodic_covering(i).report();
+            });
+        }
+
+        add_job("periodic (3) => first homoclinic covering", [this]()
+        {
+            m_coverings_test.check_jump_covering().report();
+        });
+
+        add_job("parallelogram coverings beginning", [this]()
+        {
+            m_coverings_test.parallelogram_covering_beginning_check();
+        });
+
+        add_job("parallelogram coverings derivative", [this]()
+        {
+            CoveringRelationsTest_ParallelogramCoveringDerivativeCheck<MapT> test { m_context };
+            test.parallelogram_covering_derivative_check();
+        });
+    }
+
+    size_t get_job_count() const noexcept
+    {
+        return m_jobs.size();
+    }
+
+    ShardResults run(const ShardSpec& spec)
+    {
+        ShardResults ret {};
+        ret.shard_idx = spec.index;
+        ret.shard_count = spec.count;
+        ret.job_count = m_jobs.size();
+
+        for (size_t i = 0; i < m_jobs.size(); ++i)
+        {
+            if (!spec.owns(i))
+            {
+                continue;
+            }
+
+            ShardJobResult result {};
+            result.job_idx = i;
+            result.name = m_jobs.at(i).name;
+
+            const size_t failures_before = get_failure_count();
+            const auto start = std::chrono::steady_clock::now();
+
+            try
+            {
+                m_jobs.at(i).function();
+            }
+            catch (const std::exception& e)
+            {
+                ADD_FAILURE() << result.name << ": " << e.what();
+            }
+
+            const auto stop = std::chrono::steady_clock::now();
+
+            result.passed = get_failure_count() == failures_before;
+            result.duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+
+            ret.jobs.push_back(result);
+        }
+
+        return ret;
+    }
+
+private:
+    struct Job
+    {
+        std::string name {};
+        std::function<void()> function {};
+    };
+
+    void add_job(std::string name, std::function<void()> function)
+    {
+        m_jobs.push_back(Job{ std::move(name), std::move(function) });
+    }
+
+    static size_t get_failure_count()
+    {
+        const ::testing::TestResult* result = ::testing::UnitTest::GetInstance()->current_test_info()->result();
+
+        size_t ret = 0;
+        for (int i = 0; i < result->total_part_count(); ++i)
+        {
+            if (result->GetTestPartResult(i).failed())
+            {
+                ++ret;
+            }
+        }
+
+        return ret;
+    }
+
+    ProofContext<MapT>& m_context;
+
+    CoveringRelationsTest<MapT> m_coverings_test { m_context };
+
+    // processes of the other shards run on the same machine, hence a single job uses a single thread
+    const unsigned m_coverings_test_worker_count { 1 };
+
+    std::vector<Job> m_jobs {};
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Merge result files of all shards into a single pass/fail report with timings
+//! @details A shard whose result file is missing, unreadable or inconsistent with the other shards (e.g. the shard crashed
+//!          or was launched with another shard count) is reported as missing together with all of its jobs, the jobs of the
+//!          other shards are still reported with their timings.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ShardReportMerger
+{
+public:
+    explicit ShardReportMerger(const ShardSpec& spec) : m_spec(spec)
+    {
+        std::vector<ShardResults> shard_results(spec.count);
+        m_shard_errors.resize(spec.count);
+
+        for (size_t shard_idx = 0; shard_idx < spec.count; ++shard_idx)
+        {
+            try
+            {
+                shard_results.at(shard_idx) = read_shard(spec, shard_idx);
+            }
+            catch (const std::exception& e)
+            {
+                m_shard_errors.at(shard_idx) = e.what();
+            }
+        }
+
+        // total number of jobs is written by every shard, it is taken from the first readable one
+        bool job_count_known = false;
+        for (size_t shard_idx = 0; shard_idx < spec.count; ++shard_idx)
+        {
+            if (!m_shard_errors.at(shard_idx).empty())
+            {
+                continue;
+            }
+
+            const ShardResults& results = shard_results.at(shard_idx);
+
+            if (!job_count_known)
+            {
+                m_jobs.resize(results.job_count);
+                m_reported.resize(results.job_count, false);
+                job_count_known = true;
+            }
+
+            if (results.job_count != m_jobs.size())
+            {
+                m_shard_errors.at(shard_idx) = "job count " + std::to_string(results.job_count) + " differs from "
+                    + std::to_string(m_jobs.size()) + " of the other shards";
+                continue;
+            }
+
+            for (const ShardJobResult& job : results.jobs)
+            {
+                m_jobs.at(job.job_idx) = job;
+                m_reported.at(job.job_idx) = true;
+            }
+        }
+
+        m_shard_durations_ms.resize(spec.count, 0);
+        for (size_t shard_idx = 0; shard_idx < spec.count; ++shard_idx)
+        {
+            for (const ShardJobResult& job : shard_results.at(shard_idx).jobs)
+            {
+                m_shard_durations_ms.at(shard_idx) += job.duration_ms;
+            }
+        }
+    }
+
+    bool is_successful() const
+    {
+        for (const std::string& error : m_shard_errors)
+        {
+            if (!error.empty())
+            {
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < m_jobs.size(); ++i)
+        {
+            if (!m_reported.at(i) || !m_jobs.at(i).passed)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void print_report(std::ostream& out) const
+    {
+        for (size_t i = 0; i < m_jobs.size(); ++i)
+        {
+            const ShardJobResult& job = m_jobs.at(i);
+
+            out << std::setw(4) << i << "  ";
+            if (!m_reported.at(i))
+            {
+                out << "MISSING" << std::setw(15) << "" << "shard " << i % m_spec.count << '\n';
+                continue;
+            }
+
+            out << (job.passed ? "PASSED " : "FAILED ") << std::setw(10) << job.duration_ms << " ms  " << job.name << '\n';
+        }
+
+        for (size_t shard_idx = 0; shard_idx < m_spec.count; ++shard_idx)
+        {
+            out << "shard " << shard_idx << ": ";
+            if (!m_shard_errors.at(shard_idx).empty())
+            {
+                out << "MISSING (" << m_shard_errors.at(shard_idx) << ")\n";
+                continue;
+            }
+
+            out << m_shard_durations_ms.at(shard_idx) << " ms\n";
+        }
+
+        out << (is_successful() ? "PASSED" : "FAILED") << '\n';
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Report every job as gtest expectation
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void report() const
+    {
+        print_report(std::cout);
+
+        for (size_t shard_idx = 0; shard_idx < m_spec.count; ++shard_idx)
+        {
+            EXPECT_TRUE(m_shard_errors.at(shard_idx).empty()) << "shard " << shard_idx << ": " << m_shard_errors.at(shard_idx);
+        }
+
+        for (size_t i = 0; i < m_jobs.size(); ++i)
+        {
+            EXPECT_TRUE(m_reported.at(i)) << "job " << i << " missing in shard results";
+            EXPECT_TRUE(m_jobs.at(i).passed) << m_jobs.at(i).name;
+        }
+    }
+
+private:
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Read result file of a shard and check that it is consistent with the specification
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static ShardResults read_shard(const ShardSpec& spec, size_t shard_idx)
+    {
+        const std::string path = spec.get_result_path(shard_idx);
+        ShardResults ret = ShardResults::read(path);
+
+        if (ret.job_count == 0)
+        {
+            throw std::runtime_error("Shard result file " + path + " is incomplete");
+        }
+
+        if (ret.shard_idx != shard_idx || ret.shard_count != spec.count)
+        {
+            throw std::runtime_error("Shard result file " + path + " belongs to another shard specification");
+        }
+
+        std::vector<bool> read(ret.job_count, false);
+        for (const ShardJobResult& job : ret.jobs)
+        {
+            if (job.job_idx >= ret.job_count || job.job_idx % spec.count != shard_idx || read.at(job.job_idx))
+            {
+                throw std::runtime_error("Shard result file " + path + " has an invalid job " + std::to_string(job.job_idx));
+            }
+
+            read.at(job.job_idx) = true;
+        }
+
+        return ret;
+    }
+
+    const ShardSpec m_spec;
+
+    std::vector<ShardJobResult> m_jobs {};
+    std::vector<bool> m_reported {};
+    std::vector<std::string> m_shard_errors {};
+    std::vector<long long> m_shard_durations_ms {};
+};
+
+}
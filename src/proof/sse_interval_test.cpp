@@ -0,0 +1,157 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "tools/test_tools.hpp"
+#include "tools/sse_interval.hpp"
+
+#include "pcr3bp_reg_basic_objects.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#if PCR3BP_SSE_INTERVAL_AVAILABLE
+
+namespace
+{
+
+Pcr3bpProof::Interval to_interval(const Pcr3bpProof::SseInterval& x)
+{
+    return Pcr3bpProof::Interval(x.lower(), x.upper());
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief SseInterval arithmetic against CAPD intervals: the same bounds for +, -, *, enclosure of the CAPD result for / and
+//!        sqrt
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_sse_interval, arithmetic)
+{
+    using namespace Pcr3bpProof;
+
+    std::mt19937 generator { 2024 };
+    std::uniform_real_distribution<double> distribution { -3.0, 3.0 };
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        double a[2] { distribution(generator), distribution(generator) };
+        double b[2] { distribution(generator), distribution(generator) };
+        std::sort(a, a + 2);
+        std::sort(b, b + 2);
+
+        const Interval a_capd(a[0], a[1]);
+        const Interval b_capd(b[0], b[1]);
+
+        const Interval sum_capd = a_capd + b_capd;
+        const Interval difference_capd = a_capd - b_capd;
+        const Interval product_capd = a_capd * b_capd;
+
+        const SseInterval a_sse(a[0], a[1]);
+        const SseInterval b_sse(b[0], b[1]);
+        const SseInterval b_positive_sse(std::fabs(b[0]) + 0.5, std::fabs(b[0]) + 0.5 + std::fabs(b[1]));
+
+        SseInterval sum {}, difference {}, product {}, quotient {}, root {};
+        {
+            const DownwardRounding rounding {};
+            sum = a_sse + b_sse;
+            difference = a_sse - b_sse;
+            product = a_sse * b_sse;
+            quotient = a_sse / b_positive_sse;
+            root = sqrt(b_positive_sse);
+        }
+
+        const Interval b_positive_capd = to_interval(b_positive_sse);
+
+        EXPECT_EQ(sum.lower(), sum_capd.leftBound());
+        EXPECT_EQ(sum.upper(), sum_capd.rightBound());
+        EXPECT_EQ(difference.lower(), difference_capd.leftBound());
+        EXPECT_EQ(difference.upper(), difference_capd.rightBound());
+        EXPECT_EQ(product.lower(), product_capd.leftBound());
+        EXPECT_EQ(product.upper(), product_capd.rightBound());
+
+        EXPECT_TRUE(subset(a_capd / b_positive_capd, to_interval(quotient)));
+        EXPECT_TRUE(subset(sqrt(b_positive_capd), to_interval(root)));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Taylor coefficients of the regularized vector field computed with SseInterval and with CAPD intervals
+//! @details The SSE coefficients must contain the coefficients computed in double precision at the midpoint of the initial
+//!          set and of the parameters, and be comparable with the CAPD coefficients.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_sse_interval, taylor_kernel)
+{
+    using namespace Pcr3bpProof;
+
+    capd::rounding::DoubleRounding::roundNearest();
+
+    using CapdKernel = Pcr3bp::RegularizedTaylorKernel<Interval>;
+    using SseKernel = Pcr3bp::RegularizedTaylorKernel<SseInterval>;
+    using DoubleKernel = Pcr3bp::RegularizedTaylorKernel<double>;
+
+    const Pcr3bp::SetupParameters<IMap> setup {};
+    const Interval h0 = Pcr3bp::RegBasicObjects<IMap>{}.m_h0;
+
+    auto to_sse = [](const Interval& x) { return SseInterval(x.leftBound(), x.rightBound()); };
+    auto to_double = [](const Interval& x) { return x.mid().leftBound(); };
+
+    const CapdKernel::Parameters parameters { setup.get_mu(1), setup.get_x(2), Interval(-1.0), Interval(1.0), h0 };
+
+    CapdKernel capd_kernel { parameters };
+    SseKernel sse_kernel { SseKernel::Parameters {
+        to_sse(parameters.mu3_i), to_sse(parameters.x_i), to_sse(parameters.epsilon), to_sse(parameters.direction), to_sse(parameters.h) } };
+    DoubleKernel double_kernel { DoubleKernel::Parameters {
+        to_double(parameters.mu3_i), to_double(parameters.x_i), to_double(parameters.epsilon), to_double(parameters.direction), to_double(parameters.h) } };
+
+    const size_t order = 20;
+    const std::vector<Interval> x0 { Interval(0.3, 0.3 + 1e-10), Interval(0.2), Interval(0.5), Interval(-0.4) };
+
+    capd_kernel.reset(order, 4);
+    sse_kernel.reset(order, 4);
+    double_kernel.reset(order, 4);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        capd_kernel.coeff(i, 0) = x0.at(i);
+        sse_kernel.coeff(i, 0) = to_sse(x0.at(i));
+        double_kernel.coeff(i, 0) = to_double(x0.at(i));
+        capd_kernel.dcoeff(i, 0, i) = Interval(1.0);
+        sse_kernel.dcoeff(i, 0, i) = SseInterval(1.0);
+        double_kernel.dcoeff(i, 0, i) = 1.0;
+    }
+
+    capd_kernel.compute();
+    double_kernel.compute();
+    {
+        const DownwardRounding rounding {};
+        sse_kernel.compute();
+    }
+
+    for (size_t k = 0; k <= order; ++k)
+    {
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const Interval capd_coeff = capd_kernel.coeff(i, k);
+            const Interval sse_coeff = to_interval(sse_kernel.coeff(i, k));
+
+            EXPECT_TRUE(subset(Interval(double_kernel.coeff(i, k)), sse_coeff)) << "coeff " << i << " of order " << k;
+
+            Interval coeff_intersection {};
+            EXPECT_TRUE(intersection(capd_coeff, sse_coeff, coeff_intersection));
+            EXPECT_LE(diam(sse_coeff).rightBound(), 2.0 * diam(capd_coeff).rightBound() + 1e-14);
+
+            for (size_t j = 0; j < 4; ++j)
+            {
+                EXPECT_TRUE(subset(Interval(double_kernel.dcoeff(i, k, j)), to_interval(sse_kernel.dcoeff(i, k, j))))
+                    << "dcoeff " << i << ", " << j << " of order " << k;
+
+                Interval dcoeff_intersection {};
+                EXPECT_TRUE(intersection(capd_kernel.dcoeff(i, k, j), to_interval(sse_kernel.dcoeff(i, k, j)), dcoeff_intersection));
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,337 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "tools/test_tools.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Parameters of the calibration of the Taylor order of the covering relation checks
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct TaylorOrderCalibration
+{
+    //! Candidate orders, the largest one is the reference
+    std::vector<unsigned> orders { 20, 30, 40, 50, 60 };
+
+    //! Candidate is accepted if its enclosures are at most this many times wider than the reference enclosures
+    double width_tolerance { 1.05 };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Read comma separated candidate orders from PCR3BP_TAYLOR_ORDERS and the tolerance from
+    //!        PCR3BP_TAYLOR_ORDER_TOLERANCE environment variables
+    //! @return False if PCR3BP_TAYLOR_ORDERS is not set (calibration disabled)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static bool from_environment(TaylorOrderCalibration& calibration)
+    {
+        const char* orders_env = std::getenv("PCR3BP_TAYLOR_ORDERS");
+        if (!orders_env)
+        {
+            return false;
+        }
+
+        calibration = TaylorOrderCalibration {};
+        calibration.orders.clear();
+
+        std::istringstream orders_stream(orders_env);
+        std::string order {};
+        while (std::getline(orders_stream, order, ','))
+        {
+            const unsigned long value = std::strtoul(order.c_str(), nullptr, 10);
+            if (value == 0)
+            {
+                throw std::logic_error("Invalid Taylor order in PCR3BP_TAYLOR_ORDERS: " + order);
+            }
+            calibration.orders.push_back(static_cast<unsigned>(value));
+        }
+
+        if (const char* tolerance_env = std::getenv("PCR3BP_TAYLOR_ORDER_TOLERANCE"))
+        {
+            const double value = std::strtod(tolerance_env, nullptr);
+            if (value >= 1.0)
+            {
+                calibration.width_tolerance = value;
+            }
+        }
+
+        assert_with_exception(!calibration.orders.empty());
+        return true;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Single calibration run: evaluation of the map and of its derivative on the whole h-set with a given order
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct TaylorOrderSample
+{
+    unsigned order { 0 };
+
+    //! False if the evaluation threw (e.g. the step control failed for a small order)
+    bool successful { false };
+
+    long long duration_us { 0 };
+
+    //! Maximal diameter of the image and of the derivative
+    double image_width { 0.0 };
+    double derivative_width { 0.0 };
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Calibration runs of a single covering relation and the order selected from them
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct TaylorOrderSelection
+{
+    std::string description {};
+    unsigned order { 0 };
+    std::vector<TaylorOrderSample> samples {};
+
+    void print(std::ostream& out) const
+    {
+        out << description << ": order " << order << '\n';
+
+        for (const TaylorOrderSample& sample : samples)
+        {
+            out << "  order " << sample.order;
+            if (!sample.successful)
+            {
+                out << " failed\n";
+                continue;
+            }
+
+            out << " time " << sample.duration_us << " us"
+                << " image_width " << sample.image_width
+                << " derivative_width " << sample.derivative_width << '\n';
+        }
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Evaluate map with every candidate order and select the fastest one whose enclosures are close to the reference
+//! @details The reference is the largest candidate order. Orders whose image or derivative enclosure is wider than
+//!          width_tolerance times the reference are rejected, as are orders whose evaluation failed. If the reference itself
+//!          fails, the largest candidate is selected, so that the covering relation check reports the failure.
+//!
+//!          The selection affects only the efficiency of the proof: every order yields rigorous enclosures, and the covering
+//!          relation is verified afterwards with the selected order.
+//!
+//! @param map_factory callable returning (a pointer to) the map for given order
+//! @param set argument of the map, e.g. the h-set N
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT, typename MapFactoryT>
+TaylorOrderSelection select_taylor_order(
+    const TaylorOrderCalibration& calibration,
+    MapFactoryT map_factory,
+    const typename MapT::VectorType& set)
+{
+    using VectorType = typename MapT::VectorType;
+    using MatrixType = typename MapT::MatrixType;
+
+    assert_with_exception(!calibration.orders.empty());
+
+    std::vector<unsigned> orders = calibration.orders;
+    std::sort(orders.begin(), orders.end());
+    orders.erase(std::unique(orders.begin(), orders.end()), orders.end());
+
+    TaylorOrderSelection ret {};
+    ret.order = orders.back();
+
+    for (unsigned order : orders)
+    {
+        TaylorOrderSample sample {};
+        sample.order = order;
+
+        try
+        {
+            auto map = map_factory(order);
+
+            MatrixType der(map->imageDimension(), map->dimension());
+
+            const auto start = std::chrono::steady_clock::now();
+            const VectorType img = (*map)(set, der);
+            const auto stop = std::chrono::steady_clock::now();
+
+            sample.duration_us = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+
+            for (size_t i = 0; i < img.dimension(); ++i)
+            {
+                sample.image_width = std::max(sample.image_width, diam(img[i]).rightBound());
+
+                for (size_t j = 0; j < der.numberOfColumns(); ++j)
+                {
+                    sample.derivative_width = std::max(sample.derivative_width, diam(der[i][j]).rightBound());
+                }
+            }
+
+            sample.successful = true;
+        }
+        catch (const std::exception&)
+        {
+            sample.successful = false;
+        }
+
+        ret.samples.push_back(sample);
+    }
+
+    const TaylorOrderSample& reference = ret.samples.back();
+    if (!reference.successful)
+    {
+        return ret;
+    }
+
+    long long best_duration_us = reference.duration_us;
+    for (const TaylorOrderSample& sample : ret.samples)
+    {
+        const bool accurate =
+            sample.image_width <= calibration.width_tolerance * reference.image_width &&
+            sample.derivative_width <= calibration.width_tolerance * reference.derivative_width;
+
+        if (sample.successful && accurate && sample.duration_us < best_duration_us)
+        {
+            best_duration_us = sample.duration_us;
+            ret.order = sample.order;
+        }
+    }
+
+    return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Taylor orders of the covering relation checks along the homoclinic orbit, per pair of consecutive coordsys
+//! @details Pairs without a selected order use the default order (the order of RegBasicObjects). The table may be stored
+//!          as a tab separated text file, so that the calibration is done once and reused, e.g. by all shards:
+//!
+//!          default_order <order>
+//!          homoclinic <pair index> <order>
+//!          ...
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TaylorOrderTable
+{
+public:
+    explicit TaylorOrderTable(unsigned default_order = 60) : m_default_order(default_order)
+    {}
+
+    unsigned get_default_order() const noexcept
+    {
+        return m_default_order;
+    }
+
+    unsigned get_homoclinic_order(size_t pair_idx) const
+    {
+        if (pair_idx < m_homoclinic_orders.size() && m_homoclinic_orders.at(pair_idx) > 0)
+        {
+            return m_homoclinic_orders.at(pair_idx);
+        }
+
+        return m_default_order;
+    }
+
+    void set_homoclinic_order(size_t pair_idx, unsigned order)
+    {
+        assert_with_exception(order > 0);
+
+        if (pair_idx >= m_homoclinic_orders.size())
+        {
+            m_homoclinic_orders.resize(pair_idx + 1, 0);
+        }
+
+        m_homoclinic_orders.at(pair_idx) = order;
+    }
+
+    void write(const std::string& path) const
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error("Unable to write Taylor order table " + path);
+        }
+
+        file << "default_order\t" << m_default_order << '\n';
+
+        for (size_t i = 0; i < m_homoclinic_orders.size(); ++i)
+        {
+            if (m_homoclinic_orders.at(i) > 0)
+            {
+                file << "homoclinic\t" << i << '\t' << m_homoclinic_orders.at(i) << '\n';
+            }
+        }
+    }
+
+    static TaylorOrderTable read(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error("Unable to read Taylor order table " + path);
+        }
+
+        TaylorOrderTable ret {};
+
+        std::string line {};
+        while (std::getline(file, line))
+        {
+            if (line.empty())
+            {
+                continue;
+            }
+
+            std::istringstream line_stream(line);
+
+            std::string key {};
+            std::getline(line_stream, key, '\t');
+
+            if (key == "default_order")
+            {
+                line_stream >> ret.m_default_order;
+            }
+            else if (key == "homoclinic")
+            {
+                size_t pair_idx = 0;
+                unsigned order = 0;
+                line_stream >> pair_idx >> order;
+
+                if (!line_stream.fail())
+                {
+                    ret.set_homoclinic_order(pair_idx, order);
+                }
+            }
+
+            if (line_stream.fail())
+            {
+                throw std::runtime_error("Malformed Taylor order table " + path + ": " + line);
+            }
+        }
+
+        return ret;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Path of the stored table from PCR3BP_TAYLOR_ORDER_TABLE environment variable (empty if not set)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static std::string get_path_from_environment()
+    {
+        const char* env = std::getenv("PCR3BP_TAYLOR_ORDER_TABLE");
+        return env ? std::string(env) : std::string();
+    }
+
+private:
+    unsigned m_default_order;
+
+    //! 0 for pairs without a selected order
+    std::vector<unsigned> m_homoclinic_orders {};
+};
+
+}
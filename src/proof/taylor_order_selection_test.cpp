@@ -0,0 +1,192 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "covering_relations_test.hpp"
+#include "taylor_order_selection.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Map of a calibration run with given enclosure width, duration proportional to the order, or a failing evaluation
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct StubOrderMap
+{
+    unsigned order { 0 };
+    double width { 0.0 };
+    bool fails { false };
+
+    unsigned dimension() const
+    {
+        return 2;
+    }
+
+    unsigned imageDimension() const
+    {
+        return 2;
+    }
+
+    Pcr3bpProof::IVector operator() (const Pcr3bpProof::IVector&, Pcr3bpProof::IMatrix& der) const
+    {
+        using Pcr3bpProof::Interval;
+
+        if (fails)
+        {
+            throw std::runtime_error("step control failed");
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(order));
+
+        der = Pcr3bpProof::IMatrix(2, 2);
+        der[0][0] = Interval(1.0 - width, 1.0 + width);
+        der[1][1] = Interval(-width, width);
+
+        return Pcr3bpProof::IVector{ Interval(-width, width), Interval(2.0 - width, 2.0 + width) };
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Select the order among 20, 40 and 60 with enclosure widths per order (widths of missing orders fail)
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+Pcr3bpProof::TaylorOrderSelection select_stub_order(const std::map<unsigned, double>& widths)
+{
+    using namespace Pcr3bpProof;
+
+    TaylorOrderCalibration calibration {};
+    calibration.orders = { 60, 20, 40 };
+
+    auto map_factory = [&widths](unsigned order)
+    {
+        const auto it = widths.find(order);
+        return std::make_unique<StubOrderMap>(StubOrderMap{ order, it != widths.end() ? it->second : 0.0, it == widths.end() });
+    };
+
+    return select_taylor_order<IMap>(calibration, map_factory, IVector{ Interval(-1.0, 1.0), Interval(-1.0, 1.0) });
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief The fastest order with enclosures close to the reference is selected, orders whose evaluation fails are rejected
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_taylor_order_selection, failed_order_rejected)
+{
+    const Pcr3bpProof::TaylorOrderSelection accepted = select_stub_order({ { 20, 1e-6 }, { 40, 1e-6 }, { 60, 1e-6 } });
+    EXPECT_EQ(accepted.order, 20u);
+
+    const Pcr3bpProof::TaylorOrderSelection selection = select_stub_order({ { 40, 1e-6 }, { 60, 1e-6 } });
+    ASSERT_EQ(selection.samples.size(), 3u);
+    EXPECT_EQ(selection.samples.at(0).order, 20u);
+    EXPECT_FALSE(selection.samples.at(0).successful);
+    EXPECT_EQ(selection.order, 40u);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Orders whose image or derivative enclosure is wider than the tolerance times the reference are rejected
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_taylor_order_selection, wide_enclosure_rejected)
+{
+    const Pcr3bpProof::TaylorOrderSelection selection = select_stub_order({ { 20, 1e-5 }, { 40, 1.04e-6 }, { 60, 1e-6 } });
+
+    ASSERT_EQ(selection.samples.size(), 3u);
+    EXPECT_TRUE(selection.samples.at(0).successful);
+    EXPECT_GT(selection.samples.at(0).image_width, 1.05 * selection.samples.at(2).image_width);
+    EXPECT_EQ(selection.order, 40u);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief The largest order is selected if the reference evaluation fails, so that the covering check reports the failure
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_taylor_order_selection, failed_reference_falls_back_to_largest_order)
+{
+    const Pcr3bpProof::TaylorOrderSelection selection = select_stub_order({ { 20, 1e-6 }, { 40, 1e-6 } });
+
+    ASSERT_EQ(selection.samples.size(), 3u);
+    EXPECT_FALSE(selection.samples.at(2).successful);
+    EXPECT_EQ(selection.order, 60u);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Stored table is read back with the same orders, blank lines are skipped
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_taylor_order_selection, table_round_trip)
+{
+    using namespace Pcr3bpProof;
+
+    TaylorOrderTable table { 50 };
+    table.set_homoclinic_order(0, 30);
+    table.set_homoclinic_order(3, 40);
+
+    const std::string path = ::testing::TempDir() + "pcr3bp_taylor_order_table_test.tsv";
+    table.write(path);
+
+    {
+        std::ofstream file(path, std::ios::app);
+        file << "\n\n";
+    }
+
+    const TaylorOrderTable loaded = TaylorOrderTable::read(path);
+
+    EXPECT_EQ(loaded.get_default_order(), 50u);
+    EXPECT_EQ(loaded.get_homoclinic_order(0), 30u);
+    EXPECT_EQ(loaded.get_homoclinic_order(1), 50u);
+    EXPECT_EQ(loaded.get_homoclinic_order(2), 50u);
+    EXPECT_EQ(loaded.get_homoclinic_order(3), 40u);
+    EXPECT_EQ(loaded.get_homoclinic_order(4), 50u);
+
+    std::remove(path.c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Covering relations along homoclinic orbit checked with the fixed Taylor order and with the calibrated orders
+//! @details Benchmark of the order selection, the candidate orders are read from PCR3BP_TAYLOR_ORDERS (the test is skipped
+//!          if it is not set). Both checks have to succeed, the durations of the checks and of the calibration are printed.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Pcr3bp_taylor_order_selection, benchmark)
+{
+    using namespace Pcr3bpProof;
+
+    TaylorOrderCalibration calibration {};
+    if (!TaylorOrderCalibration::from_environment(calibration))
+    {
+        GTEST_SKIP() << "PCR3BP_TAYLOR_ORDERS not set";
+    }
+
+    capd::rounding::DoubleRounding::roundNearest();
+
+    const unsigned worker_count = ParallelExecutor::get_default_worker_count();
+
+    ProofContext<IMap> context {};
+    CoveringRelationsTest<IMap> test { context };
+
+    auto measure = [](auto function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(stop - start).count();
+    };
+
+    const unsigned fixed_order = test.get_taylor_orders().get_default_order();
+
+    const double fixed_duration = measure([&]() { test.check_homoclinic_coverings(worker_count); });
+    const double calibration_duration = measure([&]() { test.calibrate_homoclinic_taylor_orders(calibration, worker_count); });
+    const double selected_duration = measure([&]() { test.check_homoclinic_coverings(worker_count); });
+
+    std::cout << "fixed order " << fixed_order << ": " << fixed_duration << " s\n";
+    std::cout << "calibration: " << calibration_duration << " s\n";
+    std::cout << "selected orders: " << selected_duration << " s\n";
+    std::cout << "speedup: " << fixed_duration / selected_duration
+              << " (including calibration: " << fixed_duration / (calibration_duration + selected_duration) << ")\n";
+}
@@ -9,9 +9,23 @@
 #include <capd_utils/affine_map.hpp>
 #include <capd_utils/local_poincare_wrapper.hpp>
 
+#include <memory>
+
 namespace CapdUtils
 {
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Base of the Poincare maps between local coordinate systems
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+class PoincareMapBase : public MapBase<MapT>
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+
+    virtual ScalarType get_last_evaluation_return_time() const = 0;
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //! @brief Affine Poincare map
 //! @details This component implements the map y = f(x) of the form:
@@ -22,20 +36,25 @@ namespace CapdUtils
 //!          of the dst_coordsys and is perpendicular to the third column vector of its directions matrix.
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename MapT>
-class AffinePoincareMap : public MapBase<MapT>
+class AffinePoincareMap : public PoincareMapBase<MapT>
 {
 public:
     using ScalarType = typename MapT::ScalarType;
     using VectorType = typename MapT::VectorType;
     using MatrixType = typename MapT::MatrixType;
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //! @details The Poincare map is computed by the solver instantiated with the type of the vector field, so vector fields
+    //!          derived from MapT with specialized Taylor coefficients (e.g. Pcr3bp::RegularizedVectorField4) are used as such.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename VectorFieldT>
     AffinePoincareMap(
-        MapT& vector_field,
+        VectorFieldT& vector_field,
         unsigned order,
         LocalCoordinateSystem<MapT> src_coordsys,
         LocalCoordinateSystem<MapT> dst_coordsys)
-            : m_dst_section( gen_section(dst_coordsys) )
-            , m_poincare( vector_field, order, m_dst_section, src_coordsys, dst_coordsys )
+            : m_poincare( std::make_unique<Poincare<VectorFieldT>>(vector_field, order, src_coordsys, dst_coordsys) )
     {
         assert_with_exception(vector_field.dimension() == src_coordsys.get_origin().dimension());
         assert_with_exception(vector_field.dimension() == dst_coordsys.get_origin().dimension());
@@ -44,39 +63,86 @@ public:
 
     VectorType operator() (const VectorType& vec) override
     {
-        return m_poincare(vec);
+        return (*m_poincare)(vec);
     }
 
     VectorType operator() (const VectorType& vec, MatrixType& der) override
     {
-        return m_poincare(vec, der);
+        return (*m_poincare)(vec, der);
     }
 
     unsigned dimension() const override
     {
-        return m_poincare.dimension();
+        return m_poincare->dimension();
     }
 
     unsigned imageDimension() const override
     {
-        return m_poincare.imageDimension();
+        return m_poincare->imageDimension();
     }
 
-    ScalarType get_last_evaluation_return_time() const
+    ScalarType get_last_evaluation_return_time() const override
     {
-        return m_poincare.get_last_evaluation_return_time();
+        return m_poincare->get_last_evaluation_return_time();
     }
 
 private:
-    static AffineSection<MapT> gen_section( const LocalCoordinateSystem<MapT>& coordsys )
+    template<typename VectorFieldT>
+    class Poincare : public PoincareMapBase<MapT>
     {
-        const VectorType vector_field_dir = Extract<MapT>::get_vvector(coordsys.get_directions_matrix(), 3);
-        return AffineSection<MapT>(coordsys.get_origin(), vector_field_dir);            
-    }
+    public:
+        Poincare(
+            VectorFieldT& vector_field,
+            unsigned order,
+            const LocalCoordinateSystem<MapT>& src_coordsys,
+            const LocalCoordinateSystem<MapT>& dst_coordsys)
+                : m_dst_section( gen_section(dst_coordsys) )
+                , m_poincare( vector_field, order, m_dst_section, convert(src_coordsys), convert(dst_coordsys) )
+        {}
+
+        VectorType operator() (const VectorType& vec) override
+        {
+            return m_poincare(vec);
+        }
+
+        VectorType operator() (const VectorType& vec, MatrixType& der) override
+        {
+            return m_poincare(vec, der);
+        }
+
+        unsigned dimension() const override
+        {
+            return m_poincare.dimension();
+        }
+
+        unsigned imageDimension() const override
+        {
+            return m_poincare.imageDimension();
+        }
+
+        ScalarType get_last_evaluation_return_time() const override
+        {
+            return m_poincare.get_last_evaluation_return_time();
+        }
+
+    private:
+        static LocalCoordinateSystem<VectorFieldT> convert( const LocalCoordinateSystem<MapT>& coordsys )
+        {
+            return LocalCoordinateSystem<VectorFieldT>(coordsys.get_origin(), coordsys.get_directions_matrix());
+        }
+
+        static AffineSection<VectorFieldT> gen_section( const LocalCoordinateSystem<MapT>& coordsys )
+        {
+            const VectorType vector_field_dir = Extract<MapT>::get_vvector(coordsys.get_directions_matrix(), 3);
+            return AffineSection<VectorFieldT>(coordsys.get_origin(), vector_field_dir);
+        }
+
+        AffineSection<VectorFieldT> m_dst_section;
 
-    AffineSection<MapT> m_dst_section;
+        LocalPoincareWrapper<VectorFieldT, AffineSection<VectorFieldT>> m_poincare;
+    };
 
-    LocalPoincareWrapper<MapT, AffineSection<MapT>> m_poincare;
+    std::unique_ptr<PoincareMapBase<MapT>> m_poincare;
 };
 
 }
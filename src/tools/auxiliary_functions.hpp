@@ -6,6 +6,7 @@
 
 #include <capd_utils/capd/map.hpp>
 #include <capd_utils/map_base.hpp>
+#include <tools/types.hpp>
 
 namespace Pcr3bpProof
 {
@@ -23,7 +24,7 @@ public:
     
     static MapT eta(ScalarType L)
     {
-        using CapdUtils::Node;
+        using Node = NodeType<MapT>;
 
         auto func = [](Node, Node in[], int, Node out[], int, Node param[], int)
         {
@@ -43,7 +44,7 @@ public:
 
     static MapT R_Inverse(ScalarType a, ScalarType b)
     {
-        using CapdUtils::Node;
+        using Node = NodeType<MapT>;
 
         auto func = [](Node, Node in[], int, Node out[], int, Node param[], int)
         {
@@ -65,7 +66,7 @@ public:
 
     static MapT J()
     {
-        using CapdUtils::Node;
+        using Node = NodeType<MapT>;
 
         auto func = [](Node, Node in[], int, Node out[], int, Node param[], int)
         {
@@ -91,7 +92,7 @@ public:
 
     static MapT create_psi0_inverse(const std::array<ScalarType, 2>& d)
     {
-        using CapdUtils::Node;
+        using Node = NodeType<MapT>;
 
         auto func = [](Node, Node in[], int, Node out[], int, Node param[], int)
         {
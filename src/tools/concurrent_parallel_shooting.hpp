@@ -0,0 +1,266 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <capd_utils/map_base.hpp>
+#include <capd_utils/extract.hpp>
+
+#include "tools/parallel_executor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace CapdUtils
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Parallel shooting operator with concurrent evaluation of the segments
+//! @details For segments f_0, ..., f_{n-1} this component implements the map
+//!
+//!           F(x_0, ..., x_{n-1}) = (f_0(x_0) - x_1, ..., f_{n-2}(x_{n-2}) - x_{n-1}, f_{n-1}(x_{n-1})),
+//!
+//!          i.e. the same operator as ParallelShooting. The segments are independent of each other, hence they (and their
+//!          derivatives) are evaluated concurrently.
+//!
+//!          Segment maps (e.g. Poincare wrappers) have mutable evaluation state, so every worker thread uses its own clone.
+//!          A clone is an object of type SegmentsT created by the provided factory. It owns all maps it needs and provides
+//!          get_segments() returning a tuple of references to the segment maps (e.g. with std::tie). Clones are created
+//!          once in the constructor and reused in every evaluation.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT, typename SegmentsT>
+class ConcurrentParallelShooting : public MapBase<MapT>
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+    using VectorType = typename MapT::VectorType;
+    using MatrixType = typename MapT::MatrixType;
+
+    using SegmentsFactory = std::function<std::unique_ptr<SegmentsT>()>;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //!
+    //! @param worker_count maximal number of threads (limited by the number of segments)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ConcurrentParallelShooting(
+        SegmentsFactory segments_factory,
+        unsigned worker_count = Pcr3bpProof::ParallelExecutor::get_default_worker_count())
+    {
+        m_clones.emplace_back(create_clone(segments_factory));
+
+        const std::vector<std::unique_ptr<MapBase<MapT>>>& segments = m_clones.front().segments;
+
+        assert_with_exception(!segments.empty());
+
+        for (size_t i = 0; i + 1 < segments.size(); ++i)
+        {
+            assert_with_exception(segments.at(i)->imageDimension() == segments.at(i+1)->dimension());
+        }
+
+        for (const std::unique_ptr<MapBase<MapT>>& segment : segments)
+        {
+            m_input_offsets.push_back(m_dimension);
+            m_dimension += segment->dimension();
+        }
+
+        m_image_dimension = m_dimension - segments.front()->dimension() + segments.back()->imageDimension();
+
+        const size_t clone_count = std::max<size_t>(1, std::min<size_t>(worker_count, segments.size()));
+        while (m_clones.size() < clone_count)
+        {
+            m_clones.emplace_back(create_clone(segments_factory));
+        }
+    }
+
+    VectorType operator() (const VectorType& vec) override
+    {
+        this->assert_vector_size(vec, dimension(), "ConcurrentParallelShooting vec vector size mismatch (1)!");
+
+        std::vector<VectorType> imgs(get_segment_count());
+
+        evaluate_segments([&](MapBase<MapT>& segment, size_t i)
+        {
+            imgs.at(i) = segment( get_segment_input(vec, i) );
+        });
+
+        return assemble_value(vec, imgs);
+    }
+
+    VectorType operator() (const VectorType& vec, MatrixType& der) override
+    {
+        this->assert_vector_size(vec, dimension(), "ConcurrentParallelShooting vec vector size mismatch (2)!");
+
+        const size_t n = get_segment_count();
+
+        std::vector<VectorType> imgs(n);
+        std::vector<MatrixType> ders(n);
+
+        evaluate_segments([&](MapBase<MapT>& segment, size_t i)
+        {
+            ders.at(i) = MatrixType( segment.imageDimension(), segment.dimension() );
+            imgs.at(i) = segment( get_segment_input(vec, i), ders.at(i) );
+        });
+
+        der = MatrixType( imageDimension(), dimension() );
+
+        // block row i contains D f_i at the columns of x_i and -Id at the columns of x_{i+1}
+        unsigned row = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const MatrixType& der_i = ders.at(i);
+            const unsigned col = m_input_offsets.at(i);
+
+            for (unsigned r = 0; r < der_i.numberOfRows(); ++r)
+            {
+                for (unsigned c = 0; c < der_i.numberOfColumns(); ++c)
+                {
+                    der[row + r][col + c] = der_i[r][c];
+                }
+
+                if (i + 1 < n)
+                {
+                    der[row + r][m_input_offsets.at(i+1) + r] = -1.0;
+                }
+            }
+
+            row += der_i.numberOfRows();
+        }
+
+        return assemble_value(vec, imgs);
+    }
+
+    unsigned dimension() const noexcept override
+    {
+        return m_dimension;
+    }
+
+    unsigned imageDimension() const noexcept override
+    {
+        return m_image_dimension;
+    }
+
+    size_t get_clone_count() const noexcept
+    {
+        return m_clones.size();
+    }
+
+private:
+    template<typename MapU>
+    class SegmentReference : public MapBase<MapT>
+    {
+    public:
+        explicit SegmentReference(MapU& map) : m_map(map)
+        {}
+
+        VectorType operator() (const VectorType& vec) override
+        {
+            return m_map(vec);
+        }
+
+        VectorType operator() (const VectorType& vec, MatrixType& der) override
+        {
+            return m_map(vec, der);
+        }
+
+        unsigned dimension() const override
+        {
+            return m_map.dimension();
+        }
+
+        unsigned imageDimension() const override
+        {
+            return m_map.imageDimension();
+        }
+
+    private:
+        MapU& m_map;
+    };
+
+    struct Clone
+    {
+        std::unique_ptr<SegmentsT> owner {};
+        std::vector<std::unique_ptr<MapBase<MapT>>> segments {};
+    };
+
+    static Clone create_clone(const SegmentsFactory& segments_factory)
+    {
+        Clone clone {};
+        clone.owner = segments_factory();
+
+        std::apply([&clone](auto&... maps)
+        {
+            (clone.segments.emplace_back(
+                std::make_unique<SegmentReference<std::remove_reference_t<decltype(maps)>>>(maps)), ...);
+        }, clone.owner->get_segments());
+
+        return clone;
+    }
+
+    size_t get_segment_count() const noexcept
+    {
+        return m_input_offsets.size();
+    }
+
+    VectorType get_segment_input(const VectorType& vec, size_t i) const
+    {
+        return Extract<MapT>::get_vector(vec, m_input_offsets.at(i), m_clones.front().segments.at(i)->dimension());
+    }
+
+    VectorType assemble_value(const VectorType& vec, const std::vector<VectorType>& imgs) const
+    {
+        const size_t n = get_segment_count();
+
+        VectorType ret( imageDimension() );
+
+        unsigned row = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const VectorType& img = imgs.at(i);
+
+            for (unsigned r = 0; r < img.dimension(); ++r)
+            {
+                ret[row + r] = (i + 1 < n) ? img[r] - vec[m_input_offsets.at(i+1) + r] : img[r];
+            }
+
+            row += img.dimension();
+        }
+
+        return ret;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Run given function for every segment, every worker thread uses its own clone
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename FunctionT>
+    void evaluate_segments(FunctionT function)
+    {
+        std::atomic<size_t> next_clone_idx { 0 };
+
+        Pcr3bpProof::ParallelExecutor executor { static_cast<unsigned>(m_clones.size()) };
+        executor.run(
+            get_segment_count(),
+            [this, &next_clone_idx]() -> Clone*
+            {
+                return &m_clones.at(next_clone_idx++);
+            },
+            [&function](Clone* clone, size_t i)
+            {
+                function(*clone->segments.at(i), i);
+            });
+    }
+
+    std::vector<Clone> m_clones {};
+
+    std::vector<unsigned> m_input_offsets {};
+    unsigned m_dimension { 0 };
+    unsigned m_image_dimension { 0 };
+};
+
+}
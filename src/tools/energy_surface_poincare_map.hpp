@@ -0,0 +1,187 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <capd_utils/composite_map.hpp>
+#include <capd_utils/local_map.hpp>
+
+#include "affine_poincare_map.hpp"
+
+#include <stdexcept>
+
+namespace CapdUtils
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Affine Poincare map computed with the vector field reduced to a 3 dimensional chart of an invariant surface
+//! @details This component implements the same map as AffinePoincareMap in 4 dimensions:
+//!
+//!           y = (dst_coordsys^{-1} \circ lift \circ P_3 \circ chart \circ src_coordsys) (x),
+//!
+//!          where P_3 is the Poincare map along the reduced vector field, so the solver integrates 3 dimensional variational
+//!          equations. The chart has to be of the form (u, v, pu, pv) -> (u, v, pu*n3 + pv*n4 + c), where (n1, n2, n3, n4) is
+//!          the third column vector of the directions matrix of dst_coordsys, and the lift has to be its right inverse on the
+//!          surface. Then the section Sigma of AffinePoincareMap corresponds to the affine section in the chart through
+//!          chart(dst origin) perpendicular to (n1, n2, 1).
+//!
+//!          The chart is not injective on the phase space, the lift is its inverse only on the part of the surface where the
+//!          branch function is positive. Hence the branch function is evaluated on the image of every argument in the phase
+//!          space and the evaluation is rejected with an exception unless it is positive on the whole image.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+class EnergySurfacePoincareMap : public PoincareMapBase<MapT>
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+    using VectorType = typename MapT::VectorType;
+    using MatrixType = typename MapT::MatrixType;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //!
+    //! @param vector_field reduced vector field, dimension 3 -> 3
+    //! @param chart dimension 4 -> 3
+    //! @param lift dimension 3 -> 4
+    //! @param branch_function dimension 4 -> 1, positive on the part of the surface on which the lift inverts the chart
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    EnergySurfacePoincareMap(
+        MapT vector_field,
+        MapT chart,
+        MapT lift,
+        MapT branch_function,
+        unsigned order,
+        const LocalCoordinateSystem<MapT>& src_coordsys,
+        const LocalCoordinateSystem<MapT>& dst_coordsys)
+            : m_vector_field(std::move(vector_field))
+            , m_chart(std::move(chart))
+            , m_lift(std::move(lift))
+            , m_branch_function(std::move(branch_function))
+            , m_src_coordsys_4_dim(src_coordsys)
+            , m_dst_coordsys_4_dim(dst_coordsys)
+            , m_affine_poincare(m_vector_field, order, m_src_coordsys_3_dim, m_dst_coordsys_3_dim)
+    {
+        assert_with_exception(m_vector_field.dimension() == 3);
+        assert_with_exception(m_vector_field.imageDimension() == 3);
+        assert_with_exception(m_chart.dimension() == 4);
+        assert_with_exception(m_chart.imageDimension() == 3);
+        assert_with_exception(m_lift.dimension() == 3);
+        assert_with_exception(m_lift.imageDimension() == 4);
+        assert_with_exception(m_branch_function.dimension() == 4);
+        assert_with_exception(m_branch_function.imageDimension() == 1);
+    }
+
+    VectorType operator() (const VectorType& vec) override
+    {
+        check_branch(vec);
+        return m_composite(vec);
+    }
+
+    VectorType operator() (const VectorType& vec, MatrixType& der) override
+    {
+        check_branch(vec);
+        return m_composite(vec, der);
+    }
+
+    unsigned dimension() const override
+    {
+        return m_composite.dimension();
+    }
+
+    unsigned imageDimension() const override
+    {
+        return m_composite.imageDimension();
+    }
+
+    ScalarType get_last_evaluation_return_time() const override
+    {
+        return m_affine_poincare.get_last_evaluation_return_time();
+    }
+
+private:
+    void check_branch(const VectorType& vec)
+    {
+        if (!(m_branch_function(m_affine_src(vec))[0] > 0.0))
+        {
+            throw std::domain_error("EnergySurfacePoincareMap argument is not on the branch of the chart!");
+        }
+    }
+
+    MapT m_vector_field;
+    MapT m_chart;
+    MapT m_lift;
+    MapT m_branch_function;
+
+    const LocalCoordinateSystem<MapT> m_src_coordsys_4_dim;
+    const LocalCoordinateSystem<MapT> m_dst_coordsys_4_dim;
+
+    AffineMap<MapT> m_affine_src
+    {
+        m_src_coordsys_4_dim
+    };
+
+    //! translation to the image of the source origin, the chart coordinates are not rescaled
+    const LocalCoordinateSystem<MapT> m_src_coordsys_3_dim
+    {
+        [this]() -> LocalCoordinateSystem<MapT>
+        {
+            MatrixType directions(3, 3);
+            directions(1, 1) = 1.0;
+            directions(2, 2) = 1.0;
+            directions(3, 3) = 1.0;
+
+            return LocalCoordinateSystem<MapT>(m_chart(m_src_coordsys_4_dim.get_origin()), directions);
+        }()
+    };
+
+    //! the third column vector is the section normal (n1, n2, 1), the other ones span the section
+    const LocalCoordinateSystem<MapT> m_dst_coordsys_3_dim
+    {
+        [this]() -> LocalCoordinateSystem<MapT>
+        {
+            const MatrixType& dst_directions = m_dst_coordsys_4_dim.get_directions_matrix();
+            const ScalarType n1 = dst_directions(1, 3);
+            const ScalarType n2 = dst_directions(2, 3);
+
+            MatrixType directions(3, 3);
+            directions(1, 1) = 1.0;
+            directions(3, 1) = -n1;
+            directions(2, 2) = 1.0;
+            directions(3, 2) = -n2;
+            directions(1, 3) = n1;
+            directions(2, 3) = n2;
+            directions(3, 3) = 1.0;
+
+            return LocalCoordinateSystem<MapT>(m_chart(m_dst_coordsys_4_dim.get_origin()), directions);
+        }()
+    };
+
+    LocalMap<MapT, MapT&> m_to_chart
+    {
+        std::ref(m_chart),
+        std::ref(m_src_coordsys_4_dim),
+        std::ref(m_src_coordsys_3_dim)
+    };
+
+    AffinePoincareMap<MapT> m_affine_poincare;
+
+    LocalMap<MapT, MapT&> m_to_phase_space
+    {
+        std::ref(m_lift),
+        std::ref(m_dst_coordsys_3_dim),
+        std::ref(m_dst_coordsys_4_dim)
+    };
+
+    CompositeMap<MapT,
+        decltype(m_to_chart)&,
+        decltype(m_affine_poincare)&,
+        decltype(m_to_phase_space)&> m_composite
+    {
+        std::ref(m_to_chart),
+        std::ref(m_affine_poincare),
+        std::ref(m_to_phase_space)
+    };
+};
+
+}
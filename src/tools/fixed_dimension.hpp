@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "tools/test_tools.hpp"
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+
+namespace CapdUtils
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Matrix with dimensions known at compile time
+//! @details Storage is a plain array, so temporaries live on the stack and the loops of the products have constant trip
+//!          counts (the compiler unrolls them for the small dimensions used in the local Poincare maps). Conversions from
+//!          and to the dynamically sized CAPD matrices check the dimensions.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename ScalarType, size_t Rows, size_t Cols>
+class FixedMatrix
+{
+public:
+    static constexpr size_t rows = Rows;
+    static constexpr size_t cols = Cols;
+
+    FixedMatrix()
+    {
+        m_data.fill(ScalarType(0.0));
+    }
+
+    template<typename MatrixType>
+    static FixedMatrix from(const MatrixType& mat)
+    {
+        assert_with_exception(mat.numberOfRows() == Rows);
+        assert_with_exception(mat.numberOfColumns() == Cols);
+
+        FixedMatrix ret {};
+        for (size_t i = 0; i < Rows; ++i)
+        {
+            for (size_t j = 0; j < Cols; ++j)
+            {
+                ret(i, j) = mat[i][j];
+            }
+        }
+        return ret;
+    }
+
+    template<typename MatrixType>
+    MatrixType to() const
+    {
+        MatrixType ret(Rows, Cols);
+        for (size_t i = 0; i < Rows; ++i)
+        {
+            for (size_t j = 0; j < Cols; ++j)
+            {
+                ret[i][j] = (*this)(i, j);
+            }
+        }
+        return ret;
+    }
+
+    //! copy to an existing matrix, which is reallocated only if its dimensions differ
+    template<typename MatrixType>
+    void to(MatrixType& mat) const
+    {
+        if (mat.numberOfRows() != Rows || mat.numberOfColumns() != Cols)
+        {
+            mat = MatrixType(Rows, Cols);
+        }
+
+        for (size_t i = 0; i < Rows; ++i)
+        {
+            for (size_t j = 0; j < Cols; ++j)
+            {
+                mat[i][j] = (*this)(i, j);
+            }
+        }
+    }
+
+    //! zero-based indexing
+    ScalarType& operator() (size_t i, size_t j)
+    {
+        return m_data[i * Cols + j];
+    }
+
+    const ScalarType& operator() (size_t i, size_t j) const
+    {
+        return m_data[i * Cols + j];
+    }
+
+    template<size_t OtherCols>
+    FixedMatrix<ScalarType, Rows, OtherCols> operator* (const FixedMatrix<ScalarType, Cols, OtherCols>& other) const
+    {
+        FixedMatrix<ScalarType, Rows, OtherCols> ret {};
+        for (size_t i = 0; i < Rows; ++i)
+        {
+            for (size_t j = 0; j < OtherCols; ++j)
+            {
+                ScalarType sum = (*this)(i, 0) * other(0, j);
+                for (size_t k = 1; k < Cols; ++k)
+                {
+                    sum += (*this)(i, k) * other(k, j);
+                }
+                ret(i, j) = sum;
+            }
+        }
+        return ret;
+    }
+
+    FixedMatrix operator* (const ScalarType& scalar) const
+    {
+        FixedMatrix ret {};
+        for (size_t i = 0; i < Rows * Cols; ++i)
+        {
+            ret.m_data[i] = m_data[i] * scalar;
+        }
+        return ret;
+    }
+
+private:
+    std::array<ScalarType, Rows * Cols> m_data;
+};
+
+}
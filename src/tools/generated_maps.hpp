@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "auxiliary_functions.hpp"
+#include "psi0_specialized.hpp"
+
+#include <codegen/generated_map.hpp>
+#include <pcr3bp_basic/levi_civita_coordinate_change.hpp>
+#include <pcr3bp_basic/levi_civita_inverse_coordinate_change.hpp>
+
+#include <pcr3bp_generated_evaluators.hpp>
+
+#include <array>
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Pieces of the inverse coordinate change evaluated by the generated evaluators (only with appended energy)
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+class GeneratedLeviCivitaInverseCoordinateChangePieces
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+
+    using Pieces = LeviCivitaInverseCoordinateChangePieces<MapT>;
+
+    using F1 = Codegen::GeneratedMap<MapT, Generated::LeviCivitaInverseF1Evaluator>;
+    using F2 = Codegen::GeneratedMap<MapT, Generated::LeviCivitaInverseF2Evaluator>;
+    using F3 = Codegen::GeneratedMap<MapT, Generated::LeviCivitaInverseF3Evaluator>;
+    using F4 = Codegen::GeneratedMap<MapT, Generated::LeviCivitaInverseF4Evaluator>;
+    using G = Codegen::GeneratedMap<MapT, Generated::LeviCivitaInverseGEvaluator>;
+
+    static unsigned dimension(bool append_h)
+    {
+        assert_with_exception(append_h);
+        return Pieces::dimension(append_h);
+    }
+
+    static F1 create_f1(ScalarType xi, bool append_h)
+    {
+        return F1{ Pieces::create_f1(xi, append_h) };
+    }
+
+    static F2 create_f2(ScalarType xi, bool append_h)
+    {
+        return F2{ Pieces::create_f2(xi, append_h) };
+    }
+
+    static F3 create_f3(ScalarType xi, bool append_h)
+    {
+        return F3{ Pieces::create_f3(xi, append_h) };
+    }
+
+    static F4 create_f4(ScalarType xi, bool append_h)
+    {
+        return F4{ Pieces::create_f4(xi, append_h) };
+    }
+
+    static G create_g(bool append_h)
+    {
+        return G{ Pieces::create_g(append_h) };
+    }
+};
+
+template<typename MapT>
+using GeneratedLeviCivitaInverseCoordinateChange =
+    LeviCivitaInverseCoordinateChange<MapT, GeneratedLeviCivitaInverseCoordinateChangePieces<MapT>>;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief A builder of the maps evaluated by the generated evaluators (see src/codegen)
+//! @details The maps are built from the same definitions as the CAPD maps (AuxiliaryFunctions, Psi0_specialized and the
+//!          Levi-Civita coordinate changes), the parameters are copied from them. Only the value and the derivative are
+//!          evaluated, so the maps replace the CAPD maps that are not integrated. The evaluators are generated for one choice
+//!          of the flags of the definitions, the builders do not take the other ones.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+class GeneratedMaps
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+
+    using Eta = Codegen::GeneratedMap<MapT, Generated::EtaEvaluator>;
+    using R_Inverse = Codegen::GeneratedMap<MapT, Generated::R_InverseEvaluator>;
+    using J = Codegen::GeneratedMap<MapT, Generated::JEvaluator>;
+    using Psi0Inverse = Codegen::GeneratedMap<MapT, Generated::Psi0InverseEvaluator>;
+    using Psi0Specialized = Codegen::GeneratedMap<MapT, Generated::Psi0SpecializedEvaluator>;
+    using LeviCivitaChange = Codegen::GeneratedMap<MapT, Generated::LeviCivitaCoordinateChangeEvaluator>;
+    using LeviCivitaChangeInverse = Codegen::GeneratedMap<MapT, Generated::LeviCivitaCoordinateChangeInverseEvaluator>;
+
+    static Eta eta(ScalarType L)
+    {
+        return Eta{ AuxiliaryFunctions<MapT>::eta(L) };
+    }
+
+    static R_Inverse r_inverse(ScalarType a, ScalarType b)
+    {
+        return R_Inverse{ AuxiliaryFunctions<MapT>::R_Inverse(a, b) };
+    }
+
+    static J j()
+    {
+        return J{ AuxiliaryFunctions<MapT>::J() };
+    }
+
+    static Psi0Inverse psi0_inverse(const std::array<ScalarType, 2>& d)
+    {
+        return Psi0Inverse{ AuxiliaryFunctions<MapT>::create_psi0_inverse(d) };
+    }
+
+    static Psi0Specialized psi0_specialized(const ScalarType& h0, const Pcr3bp::SetupParameters<MapT>& setup_parameters)
+    {
+        return Psi0Specialized{ Psi0_specialized<MapT>::create(h0, setup_parameters) };
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Full coordinate change from regularized to standard coordinates with appended energy
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static LeviCivitaChange levi_civita_change(size_t mu_index, const Pcr3bp::SetupParameters<MapT>& setup)
+    {
+        return LeviCivitaChange{ LeviCivitaCoordinateChange<MapT>::create(mu_index, setup, true, true, false) };
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Full coordinate change from standard to regularized coordinates (u > 0) with appended energy
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static LeviCivitaChangeInverse levi_civita_change_inverse(size_t mu_index, const Pcr3bp::SetupParameters<MapT>& setup)
+    {
+        return LeviCivitaChangeInverse{ LeviCivitaCoordinateChange<MapT>::createInverse(mu_index, setup, true, true) };
+    }
+};
+
+}
@@ -14,6 +14,9 @@
 
 #include "id_with_constraint.hpp"
 #include "affine_poincare_map.hpp"
+#include "energy_surface_poincare_map.hpp"
+#include "step_replay_poincare_map.hpp"
+#include "fixed_dimension.hpp"
 
 #include "local_poincare4_constraint.hpp"
 #include "local_poincare4_constraint_spec.hpp"
@@ -21,6 +24,8 @@
 #include "local_poincare4_projection.hpp"
 #include "local_poincare4_projection_spec.hpp"
 
+#include <pcr3bp_basic/energy_surface_reduction.hpp>
+
 namespace Pcr3bpProof
 {
 
@@ -30,7 +35,15 @@ namespace Pcr3bpProof
 //!
 //!     \psi_m^{-1} \circ P \circ \psi_k
 //!
-//! where indices k and m are implicitly specified with source and destination coordinate systems.
+//! where indices k and m are implicitly specified with source and destination coordinate systems. The dimensions are fixed
+//! (2 -> 4 -> 4 -> 2), so the derivative of the composition is computed with fixed-size matrices.
+//!
+//! If the energy surface reduction is given, P is computed with the vector field reduced to a chart of the energy surface
+//! (see EnergySurfacePoincareMap), unless no chart adapted to the destination section exists. Otherwise, if a step schedule
+//! is given (interval maps only), P replays its time steps before the section is approached (see StepReplayPoincareMap).
+//!
+//! Specialized psi0 coordinates require the psi0 coefficients of the proof context (see ProofContext), the specialized
+//! constraint evaluates their internal map, so it must not be evaluated concurrently by instances sharing the context.
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename MapT>
 class LocalPoincare4 : public CapdUtils::MapBase<MapT>
@@ -40,21 +53,38 @@ public:
     using VectorType = typename MapT::VectorType;
     using MatrixType = typename MapT::MatrixType;
 
+    static constexpr size_t section_dimension = 2;
+    static constexpr size_t phase_space_dimension = 4;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //!
+    //! @param vector_field MapT or a vector field derived from MapT, the Poincare map is computed with its Taylor coefficients
+    //! @param psi0_coefficients psi0 coefficients of the proof context, required if src_specialized or dst_specialized
+    //! @param energy_surface_reduction reduction of the same vector field to the energy surface or nullptr (full 4D field)
+    //! @param step_schedule time steps recorded along the trajectory of the source origin or nullptr (step control only)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename VectorFieldT>
     LocalPoincare4(
-        MapT& vector_field,
+        VectorFieldT& vector_field,
         MapT& constraint,
         unsigned order,
         const CapdUtils::LocalCoordinateSystem<MapT>& src_coordsys,
         const CapdUtils::LocalCoordinateSystem<MapT>& dst_coordsys,
         bool src_specialized,
-        bool dst_specialized)
+        bool dst_specialized,
+        Psi0_Coefficients<MapT>* psi0_coefficients = nullptr,
+        const Pcr3bp::EnergySurfaceReduction<MapT>* energy_surface_reduction = nullptr,
+        const CapdUtils::StepSchedule* step_schedule = nullptr)
             : m_vector_field(vector_field)
             , m_constraint(constraint)
             , m_order(order)
             , m_src_specialized(src_specialized)
             , m_dst_specialized(dst_specialized)
+            , m_psi0_coefficients(psi0_coefficients)
             , m_src_coordsys(specialize_coordsys(src_coordsys, src_specialized))
             , m_dst_coordsys(specialize_coordsys(dst_coordsys, dst_specialized))
+            , m_affine_poincare_ptr(create_affine_poincare(vector_field, energy_surface_reduction, step_schedule))
     {
         assert_with_exception(m_vector_field.dimension() == 4);
         assert_with_exception(m_vector_field.imageDimension() == 4);
@@ -70,6 +100,11 @@ public:
 
         assert_with_exception(src_specialized == is_u_v_pu_zero(m_src_coordsys.get_origin()));
         assert_with_exception(dst_specialized == is_u_v_pu_zero(m_dst_coordsys.get_origin()));
+
+        assert_with_exception(m_extension_to_4.dimension() == section_dimension);
+        assert_with_exception(m_extension_to_4.imageDimension() == phase_space_dimension);
+        assert_with_exception(m_projection_to_2.dimension() == phase_space_dimension);
+        assert_with_exception(m_projection_to_2.imageDimension() == section_dimension);
     }
 
     VectorType operator() (const VectorType& vec) override
@@ -77,9 +112,24 @@ public:
         return m_affine_poincare_2(vec);
     }
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Value and derivative
+    //! @details The composition is evaluated step by step into the derivative buffers of the instance and the chain rule is
+    //!          computed with fixed-size matrices, der is written in place if it already has the dimensions 2x2.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     VectorType operator() (const VectorType& vec, MatrixType& der) override
     {
-        return m_affine_poincare_2(vec, der);
+        using Matrix2x4 = CapdUtils::FixedMatrix<ScalarType, section_dimension, phase_space_dimension>;
+        using Matrix4x4 = CapdUtils::FixedMatrix<ScalarType, phase_space_dimension, phase_space_dimension>;
+        using Matrix4x2 = CapdUtils::FixedMatrix<ScalarType, phase_space_dimension, section_dimension>;
+
+        const VectorType e = m_extension_to_4(vec, m_der_extension);
+        const VectorType p = m_affine_poincare(e, m_der_poincare);
+        const VectorType ret = m_projection_to_2(p, m_der_projection);
+
+        const Matrix4x2 der_poincare_extension = Matrix4x4::from(m_der_poincare) * Matrix4x2::from(m_der_extension);
+        (Matrix2x4::from(m_der_projection) * der_poincare_extension).to(der);
+        return ret;
     }
 
     unsigned dimension() const override
@@ -97,6 +147,12 @@ public:
         return m_affine_poincare.get_last_evaluation_return_time();
     }
 
+    //! True if the Poincare map is computed with the vector field reduced to the energy surface
+    bool is_energy_surface_reduced() const noexcept
+    {
+        return m_energy_surface_reduced;
+    }
+
     void operator() (const VectorType& vec, ScalarType time, CapdUtils::SolutionCurve<MapT>& solution_curve)
     {
         const VectorType e = m_extension_to_4(vec);
@@ -133,6 +189,52 @@ private:
         return coordsys;
     }
 
+    Psi0_Coefficients<MapT>& get_psi0_coefficients() const
+    {
+        assert_with_exception(m_psi0_coefficients != nullptr);
+        return *m_psi0_coefficients;
+    }
+
+    template<typename VectorFieldT>
+    std::unique_ptr<CapdUtils::PoincareMapBase<MapT>> create_affine_poincare(
+        VectorFieldT& vector_field,
+        const Pcr3bp::EnergySurfaceReduction<MapT>* energy_surface_reduction,
+        const CapdUtils::StepSchedule* step_schedule)
+    {
+        if (energy_surface_reduction)
+        {
+            const auto chart = energy_surface_reduction->create_chart(
+                m_src_coordsys.get_origin(),
+                m_dst_coordsys.get_origin(),
+                CapdUtils::Extract<MapT>::get_vvector(m_dst_coordsys.get_directions_matrix(), 3));
+
+            if (chart)
+            {
+                m_energy_surface_reduced = true;
+
+                return std::make_unique<CapdUtils::EnergySurfacePoincareMap<MapT>>(
+                    energy_surface_reduction->create_vector_field(*chart),
+                    energy_surface_reduction->create_chart_map(*chart),
+                    energy_surface_reduction->create_lift(*chart),
+                    energy_surface_reduction->create_branch_function(*chart),
+                    m_order,
+                    m_src_coordsys,
+                    m_dst_coordsys);
+            }
+        }
+
+        if constexpr (std::is_same<MatrixType, capd::IMatrix>::value)
+        {
+            if (step_schedule)
+            {
+                return std::make_unique<CapdUtils::StepReplayPoincareMap<MapT, VectorFieldT>>(
+                    vector_field, m_order, m_src_coordsys, m_dst_coordsys, *step_schedule);
+            }
+        }
+
+        return std::make_unique<CapdUtils::AffinePoincareMap<MapT>>(vector_field, m_order, m_src_coordsys, m_dst_coordsys);
+    }
+
 
     MapT& m_vector_field;
     MapT& m_constraint;
@@ -141,16 +243,24 @@ private:
 
     const bool m_src_specialized;
     const bool m_dst_specialized;
+
+    Psi0_Coefficients<MapT>* const m_psi0_coefficients;
     
     const CapdUtils::LocalCoordinateSystem<MapT> m_src_coordsys;
     const CapdUtils::LocalCoordinateSystem<MapT> m_dst_coordsys;
 
-    CapdUtils::AffinePoincareMap<MapT> m_affine_poincare
+    bool m_energy_surface_reduced { false };
+
+    // derivatives of the steps of the composition, reused by every evaluation
+    MatrixType m_der_extension = MatrixType(phase_space_dimension, section_dimension);
+    MatrixType m_der_poincare = MatrixType(phase_space_dimension, phase_space_dimension);
+    MatrixType m_der_projection = MatrixType(section_dimension, phase_space_dimension);
+
+    std::unique_ptr<CapdUtils::PoincareMapBase<MapT>> m_affine_poincare_ptr;
+
+    CapdUtils::PoincareMapBase<MapT>& m_affine_poincare
     {
-        m_vector_field,
-        m_order,
-        m_src_coordsys,
-        m_dst_coordsys,
+        *m_affine_poincare_ptr
     };
 
     using LocalPoincare4_Constraint_BaseType = LocalPoincare4_Constraint_Base<MapT>;
@@ -165,7 +275,8 @@ private:
             return m_src_specialized ?
                 LocalPoincare4_Constraint_BaseTypePtr(std::make_unique<LocalPoincare4_Constraint_SpecType>(
                     std::ref(m_constraint),
-                    std::ref(m_src_coordsys)
+                    std::ref(m_src_coordsys),
+                    std::ref(get_psi0_coefficients())
                 )) :
                 LocalPoincare4_Constraint_BaseTypePtr(std::make_unique<LocalPoincare4_Constraint_Type>(
                     std::ref(m_constraint),
@@ -189,7 +300,9 @@ private:
         [this]() -> LocalPoincare4_Projection_BaseTypePtr
         {
             return m_dst_specialized ?
-                LocalPoincare4_Projection_BaseTypePtr(std::make_unique<LocalPoincare4_Projection_SpecType>( std::ref(m_dst_coordsys) ) ) : 
+                LocalPoincare4_Projection_BaseTypePtr(std::make_unique<LocalPoincare4_Projection_SpecType>(
+                    std::ref(m_dst_coordsys),
+                    std::ref(get_psi0_coefficients()) ) ) : 
                 LocalPoincare4_Projection_BaseTypePtr(std::make_unique<LocalPoincare4_Projection_Type>( std::ref(m_dst_coordsys) ) );
         }()
     };
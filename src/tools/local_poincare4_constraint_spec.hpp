@@ -27,11 +27,18 @@ public:
     using VectorType = typename MapT::VectorType;
     using MatrixType = typename MapT::MatrixType;
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Constructor
+    //!
+    //! @param psi0_coefficients psi0 coefficients of the proof context, its internal map is evaluated by this component
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     LocalPoincare4_Constraint_Spec(
         MapT& constraint,
-        const CapdUtils::LocalCoordinateSystem<MapT>& src_coordsys)
+        const CapdUtils::LocalCoordinateSystem<MapT>& src_coordsys,
+        Psi0_Coefficients<MapT>& psi0_coefficients)
             : LocalPoincare4_Constraint_Base<MapT>(constraint, src_coordsys)
             , m_src_coordsys_4_dim(src_coordsys)
+            , m_psi0_coefficients(psi0_coefficients)
     {}
 
     VectorType operator() (const VectorType& vec) override
@@ -57,9 +64,11 @@ public:
 private:
     const CapdUtils::LocalCoordinateSystem<MapT> m_src_coordsys_4_dim;
 
-    MapT& m_internal_map
+    Psi0_Coefficients<MapT>& m_psi0_coefficients;
+
+    typename Psi0_Coefficients<MapT>::InternalMap& m_internal_map
     {
-        Psi0_Coefficients<MapT>::get().get_internal_map_ref()
+        m_psi0_coefficients.get_internal_map_ref()
     };
 
     static CapdUtils::LocalCoordinateSystem<MapT> create_src_coordsys(std::array<ScalarType, 2> d)
@@ -79,7 +88,7 @@ private:
 
     const CapdUtils::LocalCoordinateSystem<MapT> m_src_coordsys_2_dim
     {
-        create_src_coordsys( Psi0_Coefficients<MapT>::get().get_d_coeffs() )
+        create_src_coordsys( m_psi0_coefficients.get_d_coeffs(m_src_coordsys_4_dim) )
     };
     
     CapdUtils::LocalMap<MapT,
@@ -5,7 +5,8 @@
 #pragma once
 
 #include "local_poincare4_projection_base.hpp"
-#include "auxiliary_functions.hpp"
+#include "generated_maps.hpp"
+#include "psi0_coefficients.hpp"
 
 #include <capd_utils/local_coordinate_system.hpp>
 #include <capd_utils/affine_map.hpp>
@@ -22,7 +23,11 @@ public:
     using VectorType = typename MapT::VectorType;
     using MatrixType = typename MapT::MatrixType;
 
-    LocalPoincare4_Projection_Spec(const CapdUtils::LocalCoordinateSystem<MapT>& dst_coordsys) : m_dst_coordsys_4_dim(dst_coordsys)
+    LocalPoincare4_Projection_Spec(
+        const CapdUtils::LocalCoordinateSystem<MapT>& dst_coordsys,
+        const Psi0_Coefficients<MapT>& psi0_coefficients)
+            : m_dst_coordsys_4_dim(dst_coordsys)
+            , m_psi0_coefficients(psi0_coefficients)
     {}
 
     virtual VectorType operator() (const VectorType& vec) override
@@ -48,15 +53,17 @@ public:
 private:
     CapdUtils::LocalCoordinateSystem<MapT> m_dst_coordsys_4_dim;
 
+    const Psi0_Coefficients<MapT>& m_psi0_coefficients;
+
     CapdUtils::AffineMap<MapT> m_affine_map
     {
         m_dst_coordsys_4_dim.get_origin(),
         m_dst_coordsys_4_dim.get_directions_matrix()
     };
 
-    MapT m_constraint_inverse
+    typename GeneratedMaps<MapT>::Psi0Inverse m_constraint_inverse
     {
-        AuxiliaryFunctions<MapT>::create_psi0_inverse( Psi0_Coefficients<MapT>::get().get_d_coeffs() )
+        GeneratedMaps<MapT>::psi0_inverse( m_psi0_coefficients.get_d_coeffs(m_dst_coordsys_4_dim) )
     };
 
     CapdUtils::CompositeMap<MapT,
@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Thread-safe pool of clones of a map
+//! @details CAPD maps hold mutable evaluation state, so a single map cannot be evaluated by several threads at once. The pool
+//!          keeps a prototype, built once, and hands out clones (copies of the prototype) wrapped in Lease guards. A clone
+//!          is used exclusively by the holder of its lease and goes back to the pool when the lease is destroyed, so
+//!          later leases reuse existing clones instead of rebuilding the expression trees.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+class MapClonePool
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Exclusive access to a single clone, returns the clone to the pool on destruction
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    class Lease
+    {
+    public:
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        Lease(Lease&& other) noexcept : m_pool(other.m_pool), m_clone(other.m_clone)
+        {
+            other.m_pool = nullptr;
+            other.m_clone = nullptr;
+        }
+
+        Lease& operator=(Lease&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+
+                m_pool = other.m_pool;
+                m_clone = other.m_clone;
+
+                other.m_pool = nullptr;
+                other.m_clone = nullptr;
+            }
+
+            return *this;
+        }
+
+        ~Lease()
+        {
+            release();
+        }
+
+        MapT& operator*() const noexcept
+        {
+            return *m_clone;
+        }
+
+        MapT* operator->() const noexcept
+        {
+            return m_clone;
+        }
+
+    private:
+        friend class MapClonePool;
+
+        Lease(MapClonePool& pool, MapT& clone) : m_pool(&pool), m_clone(&clone)
+        {}
+
+        void release() noexcept
+        {
+            if (m_pool)
+            {
+                m_pool->give_back(*m_clone);
+            }
+
+            m_pool = nullptr;
+            m_clone = nullptr;
+        }
+
+        MapClonePool* m_pool;
+        MapT* m_clone;
+    };
+
+    explicit MapClonePool(MapT prototype) : m_prototype(std::move(prototype))
+    {}
+
+    MapClonePool(const MapClonePool&) = delete;
+    MapClonePool& operator=(const MapClonePool&) = delete;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Lease a free clone, or a new copy of the prototype if all clones are in use
+    //! @details The pool must outlive all leases.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    Lease acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (!m_free_clones.empty())
+            {
+                MapT* clone = m_free_clones.back();
+                m_free_clones.pop_back();
+                return Lease(*this, *clone);
+            }
+        }
+
+        // The prototype is never evaluated, so it may be copied without holding the lock
+        std::unique_ptr<MapT> clone = std::make_unique<MapT>(m_prototype);
+        MapT& ret = *clone;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_clones.emplace_back(std::move(clone));
+        m_free_clones.reserve(m_clones.size()); // give_back never allocates
+        return Lease(*this, ret);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Get number of clones created so far
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    size_t get_clone_count() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_clones.size();
+    }
+
+private:
+    void give_back(MapT& clone) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free_clones.push_back(&clone);
+    }
+
+    const MapT m_prototype;
+
+    mutable std::mutex m_mutex {};
+    std::vector<std::unique_ptr<MapT>> m_clones {};
+    std::vector<MapT*> m_free_clones {};
+};
+
+}
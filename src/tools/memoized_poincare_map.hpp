@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "affine_poincare_map.hpp"
+
+#include <optional>
+#include <vector>
+
+namespace CapdUtils
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Poincare map which remembers its evaluations
+//! @details Every evaluation of the underlying map is stored together with its argument, the value, the return time and
+//!          (if requested) the derivative. Later evaluations at an identical argument (compared exactly) are answered from
+//!          the stored results without integration. Hence a segment may be evaluated as a part of a composite map and
+//!          afterwards queried for its own value and derivative at the points visited by the composite.
+//!
+//!          All evaluations are kept, the component is meant for a few evaluations along an orbit, not for large sets of
+//!          arguments.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+class MemoizedPoincareMap : public PoincareMapBase<MapT>
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+    using VectorType = typename MapT::VectorType;
+    using MatrixType = typename MapT::MatrixType;
+
+    explicit MemoizedPoincareMap(PoincareMapBase<MapT>& poincare) : m_poincare(poincare)
+    {}
+
+    VectorType operator() (const VectorType& vec) override
+    {
+        if (const Evaluation* evaluation = find(vec))
+        {
+            m_last_evaluation_return_time = evaluation->return_time;
+            return evaluation->value;
+        }
+
+        const VectorType value = m_poincare(vec);
+        store(vec, value, std::nullopt);
+        return value;
+    }
+
+    VectorType operator() (const VectorType& vec, MatrixType& der) override
+    {
+        if (const Evaluation* evaluation = find(vec); evaluation && evaluation->der)
+        {
+            m_last_evaluation_return_time = evaluation->return_time;
+            der = *evaluation->der;
+            return evaluation->value;
+        }
+
+        const VectorType value = m_poincare(vec, der);
+        store(vec, value, der);
+        return value;
+    }
+
+    unsigned dimension() const override
+    {
+        return m_poincare.dimension();
+    }
+
+    unsigned imageDimension() const override
+    {
+        return m_poincare.imageDimension();
+    }
+
+    ScalarType get_last_evaluation_return_time() const override
+    {
+        return m_last_evaluation_return_time;
+    }
+
+    //! Number of evaluations of the underlying map
+    size_t get_evaluation_count() const noexcept
+    {
+        return m_evaluation_count;
+    }
+
+private:
+    struct Evaluation
+    {
+        VectorType arg;
+        VectorType value;
+        ScalarType return_time;
+        std::optional<MatrixType> der;
+    };
+
+    const Evaluation* find(const VectorType& vec) const
+    {
+        for (const Evaluation& evaluation : m_evaluations)
+        {
+            if (is_identical(evaluation.arg, vec))
+            {
+                return &evaluation;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void store(const VectorType& vec, const VectorType& value, const std::optional<MatrixType>& der)
+    {
+        ++m_evaluation_count;
+        m_last_evaluation_return_time = m_poincare.get_last_evaluation_return_time();
+
+        for (Evaluation& evaluation : m_evaluations)
+        {
+            if (is_identical(evaluation.arg, vec))
+            {
+                evaluation = Evaluation{ vec, value, m_last_evaluation_return_time, der };
+                return;
+            }
+        }
+
+        m_evaluations.push_back(Evaluation{ vec, value, m_last_evaluation_return_time, der });
+    }
+
+    static bool is_identical(const VectorType& lhs, const VectorType& rhs)
+    {
+        if (lhs.dimension() != rhs.dimension())
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < lhs.dimension(); ++i)
+        {
+            if (!(lhs[i] == rhs[i]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    PoincareMapBase<MapT>& m_poincare;
+
+    std::vector<Evaluation> m_evaluations {};
+    ScalarType m_last_evaluation_return_time {};
+    size_t m_evaluation_count { 0 };
+};
+
+}
@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <capd_utils/capd/basic_types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Execute a fixed number of independent tasks on a pool of worker threads
+//! @details Every worker creates its own context object (inside the worker thread) with the provided factory and passes it
+//!          to every task it runs, so that maps with mutable evaluation state are never shared between threads. Rounding
+//!          mode is set to nearest in every worker before the context is created.
+//!
+//!          Exceptions thrown by tasks are collected and the one thrown by the task with the lowest index is rethrown in
+//!          the calling thread after all workers have finished.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ParallelExecutor
+{
+public:
+    explicit ParallelExecutor(unsigned worker_count = get_default_worker_count())
+        : m_worker_count(worker_count > 0 ? worker_count : 1)
+    {}
+
+    unsigned get_worker_count() const noexcept
+    {
+        return m_worker_count;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Run tasks with indices 0, ..., task_count-1
+    //!
+    //! @param context_factory callable returning worker context, called once per worker
+    //! @param task callable with signature void(Context&, size_t)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename ContextFactoryT, typename TaskT>
+    void run(size_t task_count, ContextFactoryT context_factory, TaskT task) const
+    {
+        std::vector<std::exception_ptr> task_errors(task_count);
+        std::vector<std::exception_ptr> worker_errors(m_worker_count);
+        std::atomic<size_t> next_task_idx { 0 };
+
+        auto worker = [&](size_t worker_idx)
+        {
+            try
+            {
+                capd::rounding::DoubleRounding::roundNearest();
+
+                auto context = context_factory();
+
+                for (size_t i = next_task_idx++; i < task_count; i = next_task_idx++)
+                {
+                    try
+                    {
+                        task(context, i);
+                    }
+                    catch (...)
+                    {
+                        task_errors.at(i) = std::current_exception();
+                    }
+                }
+            }
+            catch (...)
+            {
+                worker_errors.at(worker_idx) = std::current_exception();
+            }
+        };
+
+        const size_t thread_count = std::min<size_t>(m_worker_count, task_count);
+
+        if (thread_count <= 1)
+        {
+            worker(0);
+        }
+        else
+        {
+            std::vector<std::thread> threads {};
+            threads.reserve(thread_count);
+
+            for (size_t w = 0; w < thread_count; ++w)
+            {
+                threads.emplace_back(worker, w);
+            }
+
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        rethrow_first(worker_errors);
+        rethrow_first(task_errors);
+
+        if (next_task_idx < task_count)
+        {
+            throw std::logic_error("ParallelExecutor finished with unprocessed tasks!");
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Get worker count from PCR3BP_WORKER_COUNT environment variable or from hardware concurrency
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    static unsigned get_default_worker_count()
+    {
+        if (const char* env = std::getenv("PCR3BP_WORKER_COUNT"))
+        {
+            const unsigned long value = std::strtoul(env, nullptr, 10);
+            if (value > 0)
+            {
+                return static_cast<unsigned>(value);
+            }
+        }
+
+        const unsigned hardware_concurrency = std::thread::hardware_concurrency();
+        return hardware_concurrency > 0 ? hardware_concurrency : 1;
+    }
+
+private:
+    static void rethrow_first(const std::vector<std::exception_ptr>& errors)
+    {
+        for (const std::exception_ptr& error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    const unsigned m_worker_count;
+};
+
+}
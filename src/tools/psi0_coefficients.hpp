@@ -8,16 +8,23 @@
 #include <capd_utils/gauss.hpp>
 #include <capd_utils/extract.hpp>
 
-#include "psi0_specialized.hpp"
+#include <array>
 
-#include <proof/pcr3bp_reg_basic_objects.hpp>
-#include <proof/periodic_orbit_coordsys_generator.hpp>
+#include "generated_maps.hpp"
+
+#include <pcr3bp_basic/setup_parameters.hpp>
 
 namespace Pcr3bpProof
 {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //! @brief Compute coefficients d1 and d2 for psi0 map
+//! @details The coefficients are computed from the unstable direction of the periodic orbit coordsys at psi0 (the first
+//!          column vector of its directions matrix), which is passed in by the specialized constraint and projection. The
+//!          derivative of the internal map at 0 is computed once, so the coefficients may be computed concurrently.
+//!
+//!          An instance is owned by every proof context (see ProofContext), the internal map is shared by the specialized
+//!          constraints of that context. It is evaluated by the generated evaluator of Psi0_specialized.
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename MapT>
 class Psi0_Coefficients
@@ -27,35 +34,50 @@ public:
     using VectorType = typename MapT::VectorType;
     using MatrixType = typename MapT::MatrixType;
 
-    static Psi0_Coefficients& get()
-    {
-        static Psi0_Coefficients s_instance {};
-        return s_instance;
-    }
-    
-    MapT& get_internal_map_ref() noexcept
+    using InternalMap = typename GeneratedMaps<MapT>::Psi0Specialized;
+
+    Psi0_Coefficients(const Pcr3bp::SetupParameters<MapT>& setup, ScalarType h0)
+        : m_internal_map(GeneratedMaps<MapT>::psi0_specialized(h0, setup))
+    {}
+
+    Psi0_Coefficients(const Psi0_Coefficients&) = delete;
+    Psi0_Coefficients& operator=(const Psi0_Coefficients&) = delete;
+
+    InternalMap& get_internal_map_ref() noexcept
     {
         return m_internal_map;
     }
 
-    const std::array<ScalarType, 2>& get_d_coeffs() const noexcept
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Least squares coefficients (d1, d2) of the unstable direction in the columns of the derivative of the internal
+    //!        map at 0
+    //!
+    //! @param coordsys periodic orbit coordsys at psi0 (possibly specialized, only the unstable direction is used)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    std::array<ScalarType, 2> get_d_coeffs(const CapdUtils::LocalCoordinateSystem<MapT>& coordsys) const
     {
-        return m_d;
+        const VectorType unstable_dir = CapdUtils::Extract<MapT>::get_vvector(coordsys.get_directions_matrix(), 1);
+
+        const VectorType unstable_dir_reg = m_internal_der_transposed * unstable_dir;
+        const VectorType d_coeff = CapdUtils::gauss<MapT>(m_internal_der_normal, unstable_dir_reg);
+
+        return std::array<ScalarType, 2>
+        {
+            d_coeff[0],
+            d_coeff[1]
+        };
     }
 
 private:
-    Psi0_Coefficients()
-    {}
-
-    static std::array<ScalarType, 2> compute_d_coeffs(
-        MapT& internal_map,
-        const CapdUtils::LocalCoordinateSystem<MapT>& dst_coordsys)
+    static MatrixType compute_internal_der(InternalMap& internal_map)
     {
-        const VectorType unstable_dir = CapdUtils::Extract<MapT>::get_vvector(dst_coordsys.get_directions_matrix(), 1);
-
         MatrixType dd(4, 2);
         internal_map( VectorType(2), dd );
+        return dd;
+    }
 
+    static MatrixType transpose(const MatrixType& dd)
+    {
         MatrixType dd2(2,4);
         for (int i = 1; i <= 2; ++i)
         {
@@ -64,45 +86,24 @@ private:
                 dd2(i,j) = dd(j,i);
             }
         }
-
-        const MatrixType ddx = dd2 * dd;
-
-        const VectorType unstable_dir_reg = dd2 * unstable_dir;
-        const VectorType d_coeff = CapdUtils::gauss<MapT>(ddx, unstable_dir_reg);
-
-        return std::array<ScalarType, 2>
-        {
-            d_coeff[0],
-            d_coeff[1]
-        };
+        return dd2;
     }
 
-    Pcr3bp::RegBasicObjects<MapT> m_basic_objects {};
-
-    MapT m_internal_map
-    {
-        Psi0_specialized<MapT>::create( m_basic_objects.m_h0, m_basic_objects.m_setup )
-    };
+    InternalMap m_internal_map;
 
-    PeriodicOrbitCoordsysGenerator<RMap> m_periodic_orbit_coordsys_generator_approx {};
-
-    std::vector<CapdUtils::LocalCoordinateSystem<RMap>> m_periodic_orbit_coordsys_approx
+    const MatrixType m_internal_der
     {
-        m_periodic_orbit_coordsys_generator_approx.get_coordsys_container()
+        compute_internal_der(m_internal_map)
     };
 
-    RegLyapunovCollisionOrbitParameters<IMap> m_parameters {};
-
-    const CapdUtils::LocalCoordinateSystem<MapT> m_src_coordsys_4_dim
+    const MatrixType m_internal_der_transposed
     {
-        CapdUtils::LocalCoordinateSystem<IMap>(
-            m_parameters.get_initial_point(),
-            CapdUtils::matrix_cast<IMatrix>(m_periodic_orbit_coordsys_approx.at(0).get_directions_matrix()) )
+        transpose(m_internal_der)
     };
 
-    const std::array<ScalarType, 2> m_d
+    const MatrixType m_internal_der_normal
     {
-        compute_d_coeffs(m_internal_map, m_src_coordsys_4_dim)
+        m_internal_der_transposed * m_internal_der
     };
 };
 
@@ -6,6 +6,7 @@
 
 #include <capd_utils/capd/map.hpp>
 #include <capd_utils/map_base.hpp>
+#include <tools/types.hpp>
 
 #include <pcr3bp_basic/setup_parameters.hpp>
 
@@ -26,7 +27,7 @@ public:
     
     static MapT create(const ScalarType& h0, const Pcr3bp::SetupParameters<MapT>& setup_parameters)
     {
-        using CapdUtils::Node;
+        using Node = NodeType<MapT>;
 
         auto func = [](Node, Node in[], int, Node out[], int, Node param[], int)
         {
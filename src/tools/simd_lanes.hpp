@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Storage of Lanes: plain array, or a generic vector type of GCC and Clang for the usual widths
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<size_t Width>
+struct LanesStorage
+{
+    static constexpr bool is_vector = false;
+    typedef double type[Width];
+};
+
+#if defined(__GNUC__)
+template<>
+struct LanesStorage<2>
+{
+    static constexpr bool is_vector = true;
+    typedef double type __attribute__((vector_size(2 * sizeof(double))));
+};
+
+template<>
+struct LanesStorage<4>
+{
+    static constexpr bool is_vector = true;
+    typedef double type __attribute__((vector_size(4 * sizeof(double))));
+};
+
+template<>
+struct LanesStorage<8>
+{
+    static constexpr bool is_vector = true;
+    typedef double type __attribute__((vector_size(8 * sizeof(double))));
+};
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Pack of Width doubles with lane-wise arithmetic
+//! @details Used as the scalar type of the generic Taylor kernels to advance Width orbits at once. With GCC and Clang the
+//!          packs of 2, 4 and 8 lanes are stored in generic vector types, so the arithmetic is compiled to vector
+//!          instructions at every optimization level: SSE2 with the default flags, AVX2 or AVX-512 registers with
+//!          PCR3BP_NATIVE_ARCH. Other widths and compilers get loops with constant trip counts. No intrinsics are used, so
+//!          the type builds on every target.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<size_t Width>
+struct alignas(Width * sizeof(double)) Lanes
+{
+    static constexpr size_t width = Width;
+
+    typename LanesStorage<Width>::type v;
+
+    Lanes() : Lanes(0.0)
+    {}
+
+    Lanes(double value)
+    {
+        for (size_t l = 0; l < Width; ++l)
+        {
+            v[l] = value;
+        }
+    }
+
+    double& operator[] (size_t l)
+    {
+        return v[l];
+    }
+
+    const double& operator[] (size_t l) const
+    {
+        return v[l];
+    }
+
+    template<typename OperationT>
+    Lanes& apply(const Lanes& other, OperationT operation)
+    {
+        for (size_t l = 0; l < Width; ++l)
+        {
+            v[l] = operation(v[l], other.v[l]);
+        }
+        return *this;
+    }
+
+    Lanes& operator+= (const Lanes& other)
+    {
+        if constexpr (LanesStorage<Width>::is_vector)
+        {
+            v += other.v;
+            return *this;
+        }
+        else
+        {
+            return apply(other, [](double a, double b) { return a + b; });
+        }
+    }
+
+    Lanes& operator-= (const Lanes& other)
+    {
+        if constexpr (LanesStorage<Width>::is_vector)
+        {
+            v -= other.v;
+            return *this;
+        }
+        else
+        {
+            return apply(other, [](double a, double b) { return a - b; });
+        }
+    }
+
+    Lanes& operator*= (const Lanes& other)
+    {
+        if constexpr (LanesStorage<Width>::is_vector)
+        {
+            v *= other.v;
+            return *this;
+        }
+        else
+        {
+            return apply(other, [](double a, double b) { return a * b; });
+        }
+    }
+
+    Lanes& operator/= (const Lanes& other)
+    {
+        if constexpr (LanesStorage<Width>::is_vector)
+        {
+            v /= other.v;
+            return *this;
+        }
+        else
+        {
+            return apply(other, [](double a, double b) { return a / b; });
+        }
+    }
+
+    friend Lanes operator+ (Lanes lhs, const Lanes& rhs) { return lhs += rhs; }
+    friend Lanes operator- (Lanes lhs, const Lanes& rhs) { return lhs -= rhs; }
+    friend Lanes operator* (Lanes lhs, const Lanes& rhs) { return lhs *= rhs; }
+    friend Lanes operator/ (Lanes lhs, const Lanes& rhs) { return lhs /= rhs; }
+
+    friend Lanes operator* (double lhs, const Lanes& rhs) { return Lanes(lhs) * rhs; }
+    friend Lanes operator* (const Lanes& lhs, double rhs) { return lhs * Lanes(rhs); }
+
+    friend Lanes operator- (const Lanes& arg)
+    {
+        return Lanes(-1.0) * arg;
+    }
+
+    // found by argument dependent lookup, e.g. after using std::sqrt in the generic code
+    friend Lanes sqrt(const Lanes& arg)
+    {
+        Lanes ret {};
+        for (size_t l = 0; l < Width; ++l)
+        {
+            ret.v[l] = std::sqrt(arg.v[l]);
+        }
+        return ret;
+    }
+};
+
+}
@@ -10,6 +10,14 @@
 #include <capd_utils/gauss.hpp>
 #include <capd_utils/type_cast.hpp>
 
+#include "tools/test_tools.hpp"
+#include "tools/work_stealing_scheduler.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <limits>
+#include <vector>
+
 namespace Pcr3bpProof
 {
 
@@ -32,17 +40,107 @@ public:
     {}
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Check if given condition is never satisfied along the solution curve
+    //! @details Time domains of the curve pieces are bisected until the condition is excluded or the part is shorter than
+    //!          the limit. The parts are processed as a worklist by the given number of threads (every thread evaluates its
+    //!          own copy of the condition). For every piece the leftmost part on which the condition might be satisfied
+    //!          is reported, independently of the thread scheduling.
+    //!
     //! @return True if condition is never satisfied. False if it might be satisfied.
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    bool is_condition_never_satisfied(MapT condition, BoundType limit = 1e-15)
+    bool is_condition_never_satisfied(
+        MapT condition,
+        BoundType limit = 1e-15,
+        std::ostream& log = std::cout,
+        unsigned worker_count = 1)
     {
+        const size_t piece_count = this->pieces.size();
+
+        std::vector<CheckItem> initial_items {};
+        initial_items.reserve(piece_count);
+
+        for (size_t i = 0; i < piece_count; ++i)
+        {
+            const CurvePieceType& piece = *this->pieces.at(i);
+            initial_items.push_back(CheckItem{ i, piece.getLeftDomain(), piece.getRightDomain() });
+        }
+
+        // left end of the leftmost failing part found so far, parts lying to the right of it need not be checked
+        std::vector<std::atomic<BoundType>> leftmost_failure(piece_count);
+        for (std::atomic<BoundType>& failure : leftmost_failure)
+        {
+            failure = std::numeric_limits<BoundType>::infinity();
+        }
+
+        std::vector<std::vector<CheckItem>> failures(worker_count > 0 ? worker_count : 1);
+
+        WorkStealingScheduler<CheckItem> scheduler { worker_count };
+        scheduler.run(
+            initial_items,
+            [&condition]() -> MapT
+            {
+                return condition;
+            },
+            [&](MapT& worker_condition, size_t worker_idx, CheckItem item, auto push)
+            {
+                std::atomic<BoundType>& failure = leftmost_failure.at(item.piece_idx);
+
+                if (item.left >= failure)
+                {
+                    return;
+                }
+
+                CurvePieceType& piece = *this->pieces.at(item.piece_idx);
+
+                if (is_excluded(worker_condition, piece, item))
+                {
+                    return;
+                }
+
+                const ScalarType arg = ScalarType( item.left, item.right );
+
+                if (CapdUtils::span(arg) < limit)
+                {
+                    failures.at(worker_idx).push_back(item);
+
+                    BoundType current = failure;
+                    while (item.left < current && !failure.compare_exchange_weak(current, item.left))
+                    {}
+
+                    return;
+                }
+
+                // Split the time interval, the left part is pushed last, so that it is checked first
+                const BoundType split_point = CapdUtils::scalar_cast<BoundType>(arg);
+
+                push(CheckItem{ item.piece_idx, split_point, item.right });
+                push(CheckItem{ item.piece_idx, item.left, split_point });
+            });
+
+        std::vector<const CheckItem*> reported(piece_count, nullptr);
+        for (const std::vector<CheckItem>& worker_failures : failures)
+        {
+            for (const CheckItem& item : worker_failures)
+            {
+                const CheckItem*& current = reported.at(item.piece_idx);
+                if (!current || item.left < current->left)
+                {
+                    current = &item;
+                }
+            }
+        }
+
         bool ret = true;
-        
-        for (CurvePieceType*& piece_ptr : this->pieces)
+
+        for (const CheckItem* item : reported)
         {
-            CurvePieceType& piece = *piece_ptr;
+            if (item)
+            {
+                const ScalarType arg = ScalarType( item->left, item->right );
+                print_var_to(log, arg);
 
-            ret &= internal_check(condition, limit, piece, piece.getLeftDomain(), piece.getRightDomain());
+                ret = false;
+            }
         }
 
         return ret;
@@ -50,34 +148,27 @@ public:
 
 private:
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    //! @brief Check if given condition is never satisfied for the specified curve piece
-    //! @return True if condition is never satisfied. False if it might be satisfied.
+    //! @brief Part of the time domain of the curve piece with given index
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct CheckItem
+    {
+        size_t piece_idx { 0 };
+        BoundType left {};
+        BoundType right {};
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @return True if condition is never satisfied on the given part of the curve piece
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    static bool internal_check(MapT condition, BoundType limit, CurvePieceType& piece, BoundType left, BoundType right)
+    static bool is_excluded(MapT& condition, CurvePieceType& piece, const CheckItem& item)
     {
-        const ScalarType arg = ScalarType( left, right );
+        const ScalarType arg = ScalarType( item.left, item.right );
         const VectorType img = piece(arg);
 
         MatrixType condition_derivative( condition.imageDimension(), condition.dimension() );
         const VectorType val = condition(img, condition_derivative);
 
-        if (image_does_not_intersect_with_zero(val))
-        {
-            return true;
-        }
-
-        if (CapdUtils::span(arg) < limit)
-        {
-            print_var(arg);
-            return false;
-        }
-
-        // Split the time interval and perform the check on parts recursively...
-        const BoundType split_point = CapdUtils::scalar_cast<BoundType>(arg);
-
-        return
-            internal_check( condition, limit, piece, left, split_point ) &&
-            internal_check( condition, limit, piece, split_point, right );
+        return image_does_not_intersect_with_zero(val);
     }
 
     static bool image_does_not_intersect_with_zero(VectorType image)
@@ -0,0 +1,193 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cfenv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PCR3BP_SSE_INTERVAL_AVAILABLE 1
+#else
+#define PCR3BP_SSE_INTERVAL_AVAILABLE 0
+#endif
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Sets the rounding mode to downward for its lifetime, the previous mode is restored on destruction
+//! @details SseInterval arithmetic is valid only within the scope of this object.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class DownwardRounding
+{
+public:
+    DownwardRounding() : m_previous(std::fegetround())
+    {
+        std::fesetround(FE_DOWNWARD);
+    }
+
+    ~DownwardRounding()
+    {
+        std::fesetround(m_previous);
+    }
+
+    DownwardRounding(const DownwardRounding&) = delete;
+    DownwardRounding& operator= (const DownwardRounding&) = delete;
+
+private:
+    const int m_previous;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Selection of the interval arithmetic of the Taylor kernels, read once from PCR3BP_INTERVAL_KERNEL
+//! @details CAPD intervals are the default, "sse" selects SseInterval where available.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+inline bool use_sse_intervals()
+{
+    static const bool s_use = []()
+    {
+        const char* const value = std::getenv("PCR3BP_INTERVAL_KERNEL");
+        const bool requested = (value != nullptr) && std::strcmp(value, "sse") == 0;
+        return requested && PCR3BP_SSE_INTERVAL_AVAILABLE;
+    }();
+
+    return s_use;
+}
+
+#if PCR3BP_SSE_INTERVAL_AVAILABLE
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Interval stored in one SSE register as (lower bound, negated upper bound)
+//! @details With the rounding mode set downward (DownwardRounding) both bounds are computed by one instruction with a single
+//!          rounding mode: rounding -hi downward is rounding hi upward. There is no switching of the rounding mode and no
+//!          branching in addition, subtraction and multiplication:
+//!
+//!           [a] + [b]:  (a_lo + b_lo, (-a_hi) + (-b_hi)),
+//!           [a] - [b]:  (a_lo + (-b_hi), (-a_hi) + b_lo),
+//!           [a] * [b]:  lane-wise minimum of (x y, (-x) y) over the four pairs of bounds.
+//!
+//!          Division requires a divisor not containing zero, square roots a non-negative argument (std::domain_error
+//!          otherwise). Bounds are assumed finite.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class SseInterval
+{
+public:
+    SseInterval() : m_value(_mm_setzero_pd())
+    {}
+
+    SseInterval(double value) : m_value(_mm_set_pd(-value, value))
+    {}
+
+    SseInterval(double lower, double upper) : m_value(_mm_set_pd(-upper, lower))
+    {}
+
+    double lower() const
+    {
+        return _mm_cvtsd_f64(m_value);
+    }
+
+    double upper() const
+    {
+        return -_mm_cvtsd_f64(_mm_unpackhi_pd(m_value, m_value));
+    }
+
+    SseInterval& operator+= (const SseInterval& other)
+    {
+        m_value = _mm_add_pd(m_value, other.m_value);
+        return *this;
+    }
+
+    SseInterval& operator-= (const SseInterval& other)
+    {
+        m_value = _mm_add_pd(m_value, swapped(other.m_value));
+        return *this;
+    }
+
+    SseInterval& operator*= (const SseInterval& other)
+    {
+        const __m128d lo = _mm_unpacklo_pd(m_value, m_value);
+        const __m128d hi = _mm_unpackhi_pd(m_value, m_value);
+        const __m128d sign = _mm_set_pd(-1.0, 1.0);
+
+        // (x, -x) for both bounds x of this interval
+        const __m128d a_lo = _mm_mul_pd(lo, sign);
+        const __m128d a_hi = _mm_mul_pd(hi, _mm_set_pd(1.0, -1.0));
+
+        // (y, y) for both bounds y of the other interval
+        const __m128d b_lo = _mm_unpacklo_pd(other.m_value, other.m_value);
+        const __m128d b_hi = _mm_xor_pd(_mm_unpackhi_pd(other.m_value, other.m_value), _mm_set1_pd(-0.0));
+
+        const __m128d p1 = _mm_mul_pd(a_lo, b_lo);
+        const __m128d p2 = _mm_mul_pd(a_lo, b_hi);
+        const __m128d p3 = _mm_mul_pd(a_hi, b_lo);
+        const __m128d p4 = _mm_mul_pd(a_hi, b_hi);
+
+        m_value = _mm_min_pd(_mm_min_pd(p1, p2), _mm_min_pd(p3, p4));
+        return *this;
+    }
+
+    SseInterval& operator/= (const SseInterval& other)
+    {
+        return *this *= reciprocal(other);
+    }
+
+    friend SseInterval operator+ (SseInterval lhs, const SseInterval& rhs) { return lhs += rhs; }
+    friend SseInterval operator- (SseInterval lhs, const SseInterval& rhs) { return lhs -= rhs; }
+    friend SseInterval operator* (SseInterval lhs, const SseInterval& rhs) { return lhs *= rhs; }
+    friend SseInterval operator/ (SseInterval lhs, const SseInterval& rhs) { return lhs /= rhs; }
+
+    friend SseInterval operator* (double lhs, const SseInterval& rhs) { return SseInterval(lhs) * rhs; }
+    friend SseInterval operator* (const SseInterval& lhs, double rhs) { return lhs * SseInterval(rhs); }
+
+    friend SseInterval operator- (const SseInterval& arg)
+    {
+        return SseInterval(swapped(arg.m_value));
+    }
+
+    // found by argument dependent lookup, e.g. after using std::sqrt in the generic code
+    friend SseInterval sqrt(const SseInterval& arg)
+    {
+        if (arg.lower() < 0.0)
+        {
+            throw std::domain_error("SseInterval sqrt of an interval with negative values!");
+        }
+
+        // rounded downward, the upper bound is moved up by one ulp
+        const __m128d roots = _mm_sqrt_pd(_mm_set_pd(arg.upper(), arg.lower()));
+        const double upper = std::nextafter(_mm_cvtsd_f64(_mm_unpackhi_pd(roots, roots)), std::numeric_limits<double>::infinity());
+        return SseInterval(_mm_cvtsd_f64(roots), upper);
+    }
+
+private:
+    explicit SseInterval(__m128d value) : m_value(value)
+    {}
+
+    static __m128d swapped(__m128d value)
+    {
+        return _mm_shuffle_pd(value, value, 1);
+    }
+
+    static SseInterval reciprocal(const SseInterval& arg)
+    {
+        if (arg.lower() <= 0.0 && arg.upper() >= 0.0)
+        {
+            throw std::domain_error("SseInterval division by an interval containing zero!");
+        }
+
+        // (1 / hi, -1 / lo) = (-1 / (-hi), -1 / lo)
+        return SseInterval(_mm_div_pd(_mm_set1_pd(-1.0), swapped(arg.m_value)));
+    }
+
+    __m128d m_value;
+};
+
+#endif
+
+}
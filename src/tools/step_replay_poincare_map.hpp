@@ -0,0 +1,214 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <capd_utils/map_base.hpp>
+#include <capd_utils/extract.hpp>
+#include <capd_utils/gauss.hpp>
+#include <capd_utils/local_coordinate_system.hpp>
+
+#include <capd/capdlib.h>
+
+#include "affine_poincare_map.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace CapdUtils
+{
+
+//! Time steps of a trajectory from the source section to the last step before the destination section
+using StepSchedule = std::vector<double>;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Record time steps chosen by the step control of the non-rigorous solver
+//! @details The trajectory of the origin of src_coordsys is integrated until the first step which ends on the other side of
+//!          the section of AffinePoincareMap (through the origin of dst_coordsys, perpendicular to the third column vector of
+//!          its directions matrix). The steps before this one are returned, the last step is left to the Poincare map.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+class StepScheduleRecorder
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+    using VectorType = typename MapT::VectorType;
+
+    template<typename VectorFieldT>
+    static StepSchedule record(
+        VectorFieldT& vector_field,
+        unsigned order,
+        const LocalCoordinateSystem<MapT>& src_coordsys,
+        const LocalCoordinateSystem<MapT>& dst_coordsys,
+        size_t max_step_count = 100000)
+    {
+        const VectorType dst_origin = dst_coordsys.get_origin();
+        const VectorType normal = Extract<MapT>::get_vvector(dst_coordsys.get_directions_matrix(), 3);
+
+        auto section = [&](const VectorType& x) -> ScalarType
+        {
+            return (x - dst_origin) * normal;
+        };
+
+        capd::dynsys::BasicOdeSolver<VectorFieldT> solver { vector_field, order };
+
+        VectorType x = src_coordsys.get_origin();
+        ScalarType t = 0.0;
+
+        const bool positive = section(x) > 0.0;
+
+        StepSchedule ret {};
+        while (ret.size() < max_step_count)
+        {
+            const ScalarType t_prev = t;
+            x = solver(x, t);
+
+            if ((section(x) > 0.0) != positive)
+            {
+                return ret;
+            }
+
+            ret.push_back(static_cast<double>(t - t_prev));
+        }
+
+        throw std::runtime_error("StepScheduleRecorder trajectory does not reach the section!");
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Affine Poincare map which replays recorded time steps before the section is approached
+//! @details This component implements the same map as AffinePoincareMap (for interval maps only):
+//!
+//!           y = (dst_coordsys^{-1} \circ P \circ src_coordsys) (x).
+//!
+//!          The image of the argument is moved with the step control turned off by the steps of the given schedule (see
+//!          StepScheduleRecorder), so the solver does not predict the step sizes along the trajectory. Then the crossing is
+//!          found by the Poincare map with the step control turned on.
+//!
+//!          A replayed step is accepted only if the solver encloses it and the enclosure of the trajectory over the step
+//!          lies strictly on the side of the section of the image of the argument. Otherwise the set from before the step is
+//!          restored and the rest of the schedule is skipped, so the result is the first crossing as in AffinePoincareMap.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT, typename VectorFieldT>
+class StepReplayPoincareMap : public PoincareMapBase<MapT>
+{
+public:
+    using ScalarType = typename MapT::ScalarType;
+    using VectorType = typename MapT::VectorType;
+    using MatrixType = typename MapT::MatrixType;
+
+    static_assert(std::is_same<MatrixType, capd::IMatrix>::value);
+
+    StepReplayPoincareMap(
+        VectorFieldT& vector_field,
+        unsigned order,
+        const LocalCoordinateSystem<MapT>& src_coordsys,
+        const LocalCoordinateSystem<MapT>& dst_coordsys,
+        const StepSchedule& step_schedule)
+            : m_src_origin(src_coordsys.get_origin())
+            , m_src_directions(src_coordsys.get_directions_matrix())
+            , m_dst_origin(dst_coordsys.get_origin())
+            , m_dst_directions_inverse(gaussInverseMatrix<MapT>(dst_coordsys.get_directions_matrix()))
+            , m_step_schedule(step_schedule)
+            , m_solver(vector_field, order)
+            , m_section(m_dst_origin, Extract<MapT>::get_vvector(dst_coordsys.get_directions_matrix(), 3))
+            , m_poincare(m_solver, m_section)
+    {
+        assert_with_exception(vector_field.dimension() == m_src_origin.dimension());
+        assert_with_exception(vector_field.dimension() == m_dst_origin.dimension());
+        assert_with_exception(vector_field.dimension() >= 3);
+    }
+
+    VectorType operator() (const VectorType& vec) override
+    {
+        capd::C0Rect2Set set { m_src_origin, m_src_directions, vec };
+        replay(set);
+
+        const VectorType y = m_poincare(set, m_last_return_time);
+        return m_dst_directions_inverse * (y - m_dst_origin);
+    }
+
+    VectorType operator() (const VectorType& vec, MatrixType& der) override
+    {
+        capd::C1Rect2Set set { m_src_origin, m_src_directions, vec };
+        replay(set);
+
+        MatrixType monodromy(m_src_origin.dimension(), m_src_origin.dimension());
+        const VectorType y = m_poincare(set, monodromy, m_last_return_time);
+        const MatrixType dP = m_poincare.computeDP(y, monodromy, m_last_return_time);
+
+        der = m_dst_directions_inverse * dP * m_src_directions;
+        return m_dst_directions_inverse * (y - m_dst_origin);
+    }
+
+    unsigned dimension() const override
+    {
+        return m_src_origin.dimension();
+    }
+
+    unsigned imageDimension() const override
+    {
+        return m_dst_origin.dimension();
+    }
+
+    ScalarType get_last_evaluation_return_time() const override
+    {
+        return m_last_return_time;
+    }
+
+private:
+    template<typename SetT>
+    void replay(SetT& set)
+    {
+        const ScalarType s0 = m_section(VectorType(set));
+        if (!(s0 > 0.0) && !(s0 < 0.0))
+        {
+            return;
+        }
+
+        m_solver.turnOffStepControl();
+
+        for (const double step : m_step_schedule)
+        {
+            const SetT backup = set;
+
+            try
+            {
+                m_solver.setStep(step);
+                set.move(m_solver);
+            }
+            catch (const std::exception&)
+            {
+                set = backup;
+                break;
+            }
+
+            const auto& curve = m_solver.getCurve();
+            const ScalarType s = m_section(curve(ScalarType(curve.getLeftDomain(), curve.getRightDomain())));
+            if (!(s0 > 0.0 ? s > 0.0 : s < 0.0))
+            {
+                set = backup;
+                break;
+            }
+        }
+
+        m_solver.turnOnStepControl();
+    }
+
+    const VectorType m_src_origin;
+    const MatrixType m_src_directions;
+    const VectorType m_dst_origin;
+    const MatrixType m_dst_directions_inverse;
+
+    const StepSchedule& m_step_schedule;
+
+    capd::dynsys::OdeSolver<VectorFieldT> m_solver;
+    capd::poincare::AffineSection<MatrixType> m_section;
+    capd::poincare::PoincareMap<capd::dynsys::OdeSolver<VectorFieldT>, capd::poincare::AffineSection<MatrixType>> m_poincare;
+
+    ScalarType m_last_return_time { 0.0 };
+};
+
+}
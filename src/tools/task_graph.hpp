@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <capd_utils/capd/basic_types.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Directed acyclic graph of tasks executed on a pool of worker threads
+//! @details A task becomes ready once all of its dependencies have finished. Tasks whose dependency failed (threw an
+//!          exception) are not run. After the whole graph is processed, the exception of the failed task with the lowest
+//!          identifier is rethrown in the calling thread. Rounding mode is set to nearest in every worker.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TaskGraph
+{
+public:
+    using TaskId = size_t;
+    using TaskFunction = std::function<void()>;
+
+    enum class TaskState
+    {
+        Pending,
+        Finished,
+        Failed,
+        Skipped
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Add task to the graph
+    //! @details Dependencies must refer to already added tasks, which guarantees that the graph is acyclic.
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    TaskId add_task(std::string name, TaskFunction function, std::initializer_list<TaskId> dependencies = {})
+    {
+        return add_task(std::move(name), std::move(function), std::vector<TaskId>(dependencies));
+    }
+
+    TaskId add_task(std::string name, TaskFunction function, const std::vector<TaskId>& dependencies)
+    {
+        const TaskId id = m_tasks.size();
+
+        for (TaskId dependency : dependencies)
+        {
+            if (dependency >= id)
+            {
+                throw std::logic_error("TaskGraph dependency must refer to already added task!");
+            }
+
+            m_tasks.at(dependency).dependents.push_back(id);
+        }
+
+        Task task {};
+        task.name = std::move(name);
+        task.function = std::move(function);
+        task.dependency_count = dependencies.size();
+        m_tasks.emplace_back(std::move(task));
+
+        return id;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Execute all tasks
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void run(unsigned worker_count)
+    {
+        std::mutex mutex {};
+        std::condition_variable ready_cv {};
+        std::deque<TaskId> ready {};
+        size_t completed_count = 0;
+
+        std::vector<size_t> remaining_dependencies(m_tasks.size());
+        for (TaskId id = 0; id < m_tasks.size(); ++id)
+        {
+            m_tasks.at(id).state = TaskState::Pending;
+            m_tasks.at(id).error = nullptr;
+
+            remaining_dependencies.at(id) = m_tasks.at(id).dependency_count;
+            if (remaining_dependencies.at(id) == 0)
+            {
+                ready.push_back(id);
+            }
+        }
+
+        // Must be called with the mutex locked
+        std::function<void(TaskId)> complete = [&](TaskId id)
+        {
+            ++completed_count;
+
+            const bool succeeded = m_tasks.at(id).state == TaskState::Finished;
+
+            for (TaskId dependent : m_tasks.at(id).dependents)
+            {
+                if (!succeeded && m_tasks.at(dependent).state == TaskState::Pending)
+                {
+                    m_tasks.at(dependent).state = TaskState::Skipped;
+                }
+
+                if (--remaining_dependencies.at(dependent) == 0)
+                {
+                    if (m_tasks.at(dependent).state == TaskState::Skipped)
+                    {
+                        complete(dependent);
+                    }
+                    else
+                    {
+                        ready.push_back(dependent);
+                    }
+                }
+            }
+        };
+
+        auto worker = [&]()
+        {
+            capd::rounding::DoubleRounding::roundNearest();
+
+            std::unique_lock<std::mutex> lock(mutex);
+
+            while (true)
+            {
+                ready_cv.wait(lock, [&]() { return !ready.empty() || completed_count == m_tasks.size(); });
+
+                if (ready.empty())
+                {
+                    return;
+                }
+
+                const TaskId id = ready.front();
+                ready.pop_front();
+
+                Task& task = m_tasks.at(id);
+
+                lock.unlock();
+
+                const auto start = std::chrono::steady_clock::now();
+                TaskState state = TaskState::Finished;
+                std::exception_ptr error = nullptr;
+
+                try
+                {
+                    task.function();
+                }
+                catch (...)
+                {
+                    state = TaskState::Failed;
+                    error = std::current_exception();
+                }
+
+                const auto stop = std::chrono::steady_clock::now();
+
+                lock.lock();
+
+                task.state = state;
+                task.error = error;
+                task.duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
+
+                complete(id);
+                ready_cv.notify_all();
+            }
+        };
+
+        const size_t thread_count = std::max<size_t>(1, std::min<size_t>(worker_count, m_tasks.size()));
+
+        std::vector<std::thread> threads {};
+        threads.reserve(thread_count);
+
+        for (size_t w = 0; w < thread_count; ++w)
+        {
+            threads.emplace_back(worker);
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (const Task& task : m_tasks)
+        {
+            if (task.error)
+            {
+                std::rethrow_exception(task.error);
+            }
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Print state and duration of every task (in the order of addition)
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void print_summary(std::ostream& out) const
+    {
+        for (const Task& task : m_tasks)
+        {
+            out << task.name << ": " << get_state_name(task.state) << " (" << task.duration.count() << " ms)\n";
+        }
+    }
+
+    TaskState get_state(TaskId id) const
+    {
+        return m_tasks.at(id).state;
+    }
+
+    std::chrono::milliseconds get_duration(TaskId id) const
+    {
+        return m_tasks.at(id).duration;
+    }
+
+private:
+    static const char* get_state_name(TaskState state) noexcept
+    {
+        switch (state)
+        {
+            case TaskState::Pending: return "pending";
+            case TaskState::Finished: return "finished";
+            case TaskState::Failed: return "failed";
+            case TaskState::Skipped: return "skipped";
+            default: return "unknown";
+        }
+    }
+
+    struct Task
+    {
+        std::string name {};
+        TaskFunction function {};
+        size_t dependency_count { 0 };
+        std::vector<TaskId> dependents {};
+
+        TaskState state { TaskState::Pending };
+        std::exception_ptr error { nullptr };
+        std::chrono::milliseconds duration { 0 };
+    };
+
+    std::vector<Task> m_tasks {};
+};
+
+}
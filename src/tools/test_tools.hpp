@@ -11,6 +11,7 @@
 #include "types.hpp"
 
 #define print_var(var) std::cout << "" #var " " << (var) << '\n'
+#define print_var_to(stream, var) (stream) << "" #var " " << (var) << '\n'
 #define assert_with_exception(condition) if (!((condition))) throw std::logic_error("" #condition "");
 
 namespace Pcr3bpProof
@@ -19,4 +19,18 @@ using IVector = CapdUtils::IVector;
 using IMatrix = CapdUtils::IMatrix;
 using IMap = CapdUtils::IMap;
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Type of the expression nodes used to define maps of type MapT
+//! @details CAPD maps are defined with CapdUtils::Node. The code generator (src/codegen) specializes this template for its
+//!          tracing map, so the same definitions are recorded as expression graphs and compiled to C++ evaluators.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename MapT>
+struct NodeTypeOf
+{
+    using type = CapdUtils::Node;
+};
+
+template<typename MapT>
+using NodeType = typename NodeTypeOf<MapT>::type;
+
 }
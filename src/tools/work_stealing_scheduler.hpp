@@ -0,0 +1,222 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Author: Aleksander M. Pasiut
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <capd_utils/capd/basic_types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Pcr3bpProof
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//! @brief Process a dynamically growing set of work items on a pool of worker threads
+//! @details Every worker has its own deque of items. A worker takes items from the back of its own deque (depth first,
+//!          so that refinement of a single item stays local) and, once its deque is empty, steals items from the front of
+//!          the deques of other workers (the oldest, usually the largest pieces of work). Items produced while processing
+//!          an item are pushed to the deque of the worker that produced them. A worker that finds no item to take waits on a
+//!          condition variable until an item is pushed or all items are processed, so idle workers do not occupy cores
+//!          while the remaining items are processed (e.g. by other stages of FullProofTaskGraph).
+//!
+//!          As in ParallelExecutor, every worker owns a context created by the provided factory and sets rounding mode to
+//!          nearest. If processing of any item throws, the remaining items are dropped and the first exception is
+//!          rethrown in the calling thread.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename ItemT>
+class WorkStealingScheduler
+{
+public:
+    explicit WorkStealingScheduler(unsigned worker_count) : m_worker_count(worker_count > 0 ? worker_count : 1)
+    {}
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //! @brief Process initial items and all items produced during processing
+    //!
+    //! @param context_factory callable returning worker context, called once per worker
+    //! @param process callable with signature void(Context&, size_t worker_idx, ItemT item, Push push), where push(ItemT)
+    //!        schedules a new item
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename ContextFactoryT, typename ProcessT>
+    void run(const std::vector<ItemT>& initial_items, ContextFactoryT context_factory, ProcessT process)
+    {
+        std::vector<WorkerQueue> queues(m_worker_count);
+
+        // initial items are dealt round robin, so that every worker starts with its own work
+        for (size_t i = 0; i < initial_items.size(); ++i)
+        {
+            queues.at(i % m_worker_count).items.push_back(initial_items.at(i));
+        }
+
+        // items pushed and not yet processed, and items waiting in the deques
+        std::atomic<size_t> pending_count { initial_items.size() };
+        std::atomic<size_t> queued_count { initial_items.size() };
+        std::atomic<bool> aborted { false };
+
+        std::mutex idle_mutex {};
+        std::condition_variable idle_condition {};
+
+        // the state is changed before the mutex is taken, so a worker checking it under the mutex cannot miss the notification
+        auto notify_idle = [&](bool all)
+        {
+            {
+                std::lock_guard<std::mutex> lock(idle_mutex);
+            }
+
+            if (all)
+            {
+                idle_condition.notify_all();
+            }
+            else
+            {
+                idle_condition.notify_one();
+            }
+        };
+
+        std::mutex error_mutex {};
+        std::exception_ptr error { nullptr };
+
+        auto worker = [&](size_t worker_idx)
+        {
+            try
+            {
+                capd::rounding::DoubleRounding::roundNearest();
+
+                auto context = context_factory();
+
+                WorkerQueue& own_queue = queues.at(worker_idx);
+
+                auto push = [&](ItemT item)
+                {
+                    // counted before the item is visible, so queued_count never drops below the number of queued items
+                    ++pending_count;
+                    ++queued_count;
+
+                    {
+                        std::lock_guard<std::mutex> lock(own_queue.mutex);
+                        own_queue.items.push_back(std::move(item));
+                    }
+
+                    notify_idle(false);
+                };
+
+                ItemT item {};
+                while (!aborted)
+                {
+                    if (pop_back(own_queue, item) || steal(queues, worker_idx, item))
+                    {
+                        --queued_count;
+
+                        process(context, worker_idx, std::move(item), push);
+
+                        if (--pending_count == 0)
+                        {
+                            notify_idle(true);
+                        }
+                    }
+                    else
+                    {
+                        std::unique_lock<std::mutex> lock(idle_mutex);
+                        idle_condition.wait(lock, [&]()
+                        {
+                            return queued_count > 0 || pending_count == 0 || aborted;
+                        });
+
+                        if (pending_count == 0)
+                        {
+                            return;
+                        }
+                    }
+                }
+            }
+            catch (...)
+            {
+                aborted = true;
+                notify_idle(true);
+
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        };
+
+        if (m_worker_count == 1)
+        {
+            worker(0);
+        }
+        else
+        {
+            std::vector<std::thread> threads {};
+            threads.reserve(m_worker_count);
+
+            for (size_t w = 0; w < m_worker_count; ++w)
+            {
+                threads.emplace_back(worker, w);
+            }
+
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex {};
+        std::deque<ItemT> items {};
+    };
+
+    static bool pop_back(WorkerQueue& queue, ItemT& item)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.items.empty())
+        {
+            return false;
+        }
+
+        item = std::move(queue.items.back());
+        queue.items.pop_back();
+        return true;
+    }
+
+    static bool steal(std::vector<WorkerQueue>& queues, size_t worker_idx, ItemT& item)
+    {
+        for (size_t offset = 1; offset < queues.size(); ++offset)
+        {
+            WorkerQueue& victim = queues.at((worker_idx + offset) % queues.size());
+
+            std::lock_guard<std::mutex> lock(victim.mutex);
+
+            if (!victim.items.empty())
+            {
+                item = std::move(victim.items.front());
+                victim.items.pop_front();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    const unsigned m_worker_count;
+};
+
+}